@@ -24,6 +24,8 @@
 #include "constraints/variable.h"
 
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 namespace cutsat {
 
@@ -39,6 +41,12 @@ enum ConstraintType {
     ConstraintTypeCardinality,
     /** Constraints with integer coefficients */
     ConstraintTypeInteger,
+    /** Constraints with integer coefficients that fit into a native word */
+    ConstraintTypeInteger64,
+    /** Constraints over 0/1 variables with small integer coefficients */
+    ConstraintTypePseudoBoolean,
+    /** Binary problem clauses, kept as implications outside of the constraint memory */
+    ConstraintTypeBinaryClause,
     /** Last constraint type */
     ConstraintTypeLast
 };
@@ -67,6 +75,15 @@ inline std::ostream& operator << (std::ostream& out, ConstraintType type) {
     case ConstraintTypeInteger:
         out << "Integer";
         break;
+    case ConstraintTypeInteger64:
+        out << "Integer64";
+        break;
+    case ConstraintTypePseudoBoolean:
+        out << "PseudoBoolean";
+        break;
+    case ConstraintTypeBinaryClause:
+        out << "BinaryClause";
+        break;
     default:
         assert(false);
     }
@@ -306,17 +323,20 @@ public:
     }
 };
 
-template<>
-class Literal<ConstraintTypeInteger> {
+/**
+ * Literals of the linear integer constraints, parametrized by the type of the coefficient.
+ */
+template<typename Coefficient>
+class IntegerLiteral {
 
-    Integer d_coefficient;
+    Coefficient d_coefficient;
     Variable d_variable;
 
 public:
 
-    Literal(): d_coefficient(0), d_variable() {}
+    IntegerLiteral(): d_coefficient(0), d_variable() {}
 
-    Literal(const Integer& coefficient, const Variable& variable) :
+    IntegerLiteral(const Coefficient& coefficient, const Variable& variable) :
         d_coefficient(coefficient), d_variable(variable) {
     }
 
@@ -327,8 +347,8 @@ public:
     	return variableValue * d_coefficient;
     }
 
-    const Integer& getCoefficient() const { return d_coefficient; }
-    Integer& getCoefficient() { return d_coefficient; }
+    const Coefficient& getCoefficient() const { return d_coefficient; }
+    Coefficient& getCoefficient() { return d_coefficient; }
 
     void print(std::ostream& out, OutputFormat format) const {
         switch (format) {
@@ -398,15 +418,39 @@ public:
         }
     }
 
-    bool operator < (const Literal& lit) const {
+    bool operator < (const IntegerLiteral& lit) const {
         return getVariable().getId() < lit.getVariable().getId() || (getVariable().getId() == lit.getVariable().getId() && getCoefficient() < lit.getCoefficient());
     }
 
-    bool operator == (const Literal& lit) const {
+    bool operator == (const IntegerLiteral& lit) const {
         return getVariable() == lit.getVariable() && getCoefficient() == lit.getCoefficient();
     }
 };
 
+template<>
+class Literal<ConstraintTypeInteger> : public IntegerLiteral<Integer> {
+public:
+    Literal() {}
+    Literal(const Integer& coefficient, const Variable& variable)
+    : IntegerLiteral<Integer>(coefficient, variable) {}
+};
+
+template<>
+class Literal<ConstraintTypeInteger64> : public IntegerLiteral<Integer64> {
+public:
+    Literal() {}
+    Literal(const Integer64& coefficient, const Variable& variable)
+    : IntegerLiteral<Integer64>(coefficient, variable) {}
+};
+
+template<>
+class Literal<ConstraintTypePseudoBoolean> : public IntegerLiteral<boost::int32_t> {
+public:
+    Literal() {}
+    Literal(boost::int32_t coefficient, const Variable& variable)
+    : IntegerLiteral<boost::int32_t>(coefficient, variable) {}
+};
+
 template<ConstraintType type>
 std::ostream& operator << (std::ostream& out, const Literal<type>& literal) {
     literal.print(out, OutputFormatIlp);
@@ -416,6 +460,149 @@ std::ostream& operator << (std::ostream& out, const Literal<type>& literal) {
 typedef Literal<ConstraintTypeClause> ClauseConstraintLiteral;
 typedef Literal<ConstraintTypeCardinality> CardinalityConstraintLiteral;
 typedef Literal<ConstraintTypeInteger> IntegerConstraintLiteral;
+typedef Literal<ConstraintTypeInteger64> Integer64ConstraintLiteral;
+typedef Literal<ConstraintTypePseudoBoolean> PseudoBooleanConstraintLiteral;
+
+/**
+ * Literals of a constraint stored one after the other in the memory of the constraint.
+ */
+template<typename LiteralType>
+class LiteralArray {
+
+    /** The literals */
+    LiteralType* d_literals;
+
+    /** Number of literals */
+    size_t d_size;
+
+public:
+
+    typedef LiteralType& reference;
+    typedef const LiteralType& const_reference;
+
+    LiteralArray(void* memory, size_t size)
+    : d_literals((LiteralType*) memory), d_size(size) {}
+
+    /** Size of the memory needed for the given number of literals */
+    static size_t getMemorySize(size_t size) {
+        return sizeof(LiteralType)*size;
+    }
+
+    void construct(const std::vector<LiteralType>& lits) {
+        for (unsigned i = 0; i < d_size; ++ i) {
+            new (d_literals + i) LiteralType(lits[i]);
+        }
+    }
+
+    void destruct() {
+        for (unsigned i = 0; i < d_size; ++ i) {
+            d_literals[i].~LiteralType();
+        }
+    }
+
+    reference operator [] (size_t i) {
+        return d_literals[i];
+    }
+
+    const_reference operator [] (size_t i) const {
+        return d_literals[i];
+    }
+
+    Variable getVariable(size_t i) const {
+        return d_literals[i].getVariable();
+    }
+
+    void swap(size_t i, size_t j) {
+        LiteralType tmp = d_literals[i];
+        d_literals[i] = d_literals[j];
+        d_literals[j] = tmp;
+    }
+
+    template<typename T>
+    void sort(const T& cmp) {
+        std::sort(d_literals, d_literals + d_size, cmp);
+    }
+};
+
+/**
+ * Literals of the integer constraints stored as the array of the variables followed by the array
+ * of the coefficients, so that the loops over the variables don't stride over the coefficients. The
+ * literals can only be read by value, the coefficients by reference with getCoefficient().
+ */
+template<typename LiteralType, typename Coefficient>
+class SplitLiteralArray {
+
+    /** The variables */
+    Variable* d_variables;
+
+    /** The coefficients */
+    Coefficient* d_coefficients;
+
+    /** Number of literals */
+    size_t d_size;
+
+    /** Offset of the coefficients, aligned for the coefficient type */
+    static size_t getCoefficientsOffset(size_t size) {
+        return (sizeof(Variable)*size + sizeof(Coefficient) - 1) / sizeof(Coefficient) * sizeof(Coefficient);
+    }
+
+public:
+
+    typedef LiteralType reference;
+    typedef LiteralType const_reference;
+
+    SplitLiteralArray(void* memory, size_t size)
+    : d_variables((Variable*) memory), d_coefficients((Coefficient*) ((char*) memory + getCoefficientsOffset(size))), d_size(size) {}
+
+    /** Size of the memory needed for the given number of literals */
+    static size_t getMemorySize(size_t size) {
+        return getCoefficientsOffset(size) + sizeof(Coefficient)*size;
+    }
+
+    void construct(const std::vector<LiteralType>& lits) {
+        for (unsigned i = 0; i < d_size; ++ i) {
+            new (d_variables + i) Variable(lits[i].getVariable());
+            new (d_coefficients + i) Coefficient(lits[i].getCoefficient());
+        }
+    }
+
+    void destruct() {
+        for (unsigned i = 0; i < d_size; ++ i) {
+            d_coefficients[i].~Coefficient();
+        }
+    }
+
+    reference operator [] (size_t i) const {
+        return LiteralType(d_coefficients[i], d_variables[i]);
+    }
+
+    Variable getVariable(size_t i) const {
+        return d_variables[i];
+    }
+
+    const Coefficient& getCoefficient(size_t i) const {
+        return d_coefficients[i];
+    }
+
+    void swap(size_t i, size_t j) {
+        std::swap(d_variables[i], d_variables[j]);
+        std::swap(d_coefficients[i], d_coefficients[j]);
+    }
+
+    template<typename T>
+    void sort(const T& cmp) {
+        std::vector<LiteralType> lits;
+        lits.reserve(d_size);
+        for (unsigned i = 0; i < d_size; ++ i) {
+            lits.push_back((*this)[i]);
+        }
+        std::sort(lits.begin(), lits.end(), cmp);
+        for (unsigned i = 0; i < d_size; ++ i) {
+            d_variables[i] = lits[i].getVariable();
+            d_coefficients[i] = lits[i].getCoefficient();
+        }
+    }
+};
 
 template<ConstraintType type> struct ConstraintTraits;
 
@@ -425,6 +612,65 @@ inline std::ostream& operator << (std::ostream& out, const empty_data&) {
 	return out;
 }
 
+/**
+ * The activity of an integer constraint, i.e. the maximal value of the left hand side with respect to the
+ * current bounds. It is kept up to date by the solver state as the bounds change and get backtracked.
+ */
+struct activity_data {
+	/** The sum of coefficient*best(x) over the literals where best(x) is known */
+	Integer maxActivity;
+	/** The number of literals where best(x) is not known, i.e. the maximum is unbounded */
+	unsigned unbounded;
+	/** The biggest absolute value of a coefficient */
+	Integer maxCoefficient;
+	activity_data()
+	: maxActivity(0), unbounded(0), maxCoefficient(0) {}
+};
+
+inline std::ostream& operator << (std::ostream& out, const activity_data& activity) {
+	return out << "max = " << activity.maxActivity << ", unbounded = " << activity.unbounded;
+}
+
+/**
+ * The counter of a cardinality constraint. Constraints with a big constant compared to the size are not
+ * watched, but all of their literals are counted as they become false, and the count is kept up to date
+ * by the solver state as the bounds change and get backtracked.
+ */
+struct counter_data {
+	/** The number of false literals */
+	unsigned falseLiterals;
+	/** True if the constraint is propagated by the counter instead of the watches */
+	bool counting;
+	counter_data()
+	: falseLiterals(0), counting(false) {}
+};
+
+inline std::ostream& operator << (std::ostream& out, const counter_data& counter) {
+	if (counter.counting) {
+		out << "false = " << counter.falseLiterals;
+	}
+	return out;
+}
+
+/**
+ * The watches of a pseudo-Boolean constraint. Seen as a sum of weighted literals w*l >= degree, the
+ * first watched literals of the constraint are the watched ones.
+ */
+struct watched_sum_data {
+	/** The right hand side with all the literals positive */
+	Integer64 degree;
+	/** The biggest weight */
+	boost::int32_t maxWeight;
+	/** Number of watched literals */
+	unsigned watched;
+	watched_sum_data()
+	: degree(0), maxWeight(0), watched(0) {}
+};
+
+inline std::ostream& operator << (std::ostream& out, const watched_sum_data& watches) {
+	return out << "degree = " << watches.degree << ", watched = " << watches.watched;
+}
+
 template<>
 struct ConstraintTraits<ConstraintTypeClause> {
     static size_t minLiterals()     { return 2; }
@@ -432,6 +678,7 @@ struct ConstraintTraits<ConstraintTypeClause> {
     static const VariableType variableType = TypeInteger;
 
     typedef ClauseConstraintLiteral literal_type;
+    typedef LiteralArray<literal_type> literal_storage;
     typedef boost::int32_t constant_type;
     typedef boost::int32_t literal_value_type;
     typedef empty_data additional_data;
@@ -445,9 +692,10 @@ struct ConstraintTraits<ConstraintTypeCardinality> {
     static const VariableType variableType = TypeInteger;
 
     typedef CardinalityConstraintLiteral literal_type;
+    typedef LiteralArray<literal_type> literal_storage;
     typedef boost::uint32_t constant_type;
     typedef boost::int32_t literal_value_type;
-    typedef empty_data additional_data;
+    typedef counter_data additional_data;
 };
 
 template<>
@@ -457,10 +705,39 @@ struct ConstraintTraits<ConstraintTypeInteger> {
     static const VariableType variableType = TypeInteger;
 
     typedef IntegerConstraintLiteral literal_type;
+    typedef SplitLiteralArray<literal_type, Integer> literal_storage;
     typedef Integer constant_type;
     typedef Integer literal_value_type;
 
-    typedef empty_data additional_data;
+    typedef activity_data additional_data;
+};
+
+template<>
+struct ConstraintTraits<ConstraintTypeInteger64> {
+    static size_t minLiterals()    { return 2;    }
+
+    static const VariableType variableType = TypeInteger;
+
+    typedef Integer64ConstraintLiteral literal_type;
+    typedef SplitLiteralArray<literal_type, Integer64> literal_storage;
+    typedef Integer64 constant_type;
+    typedef Integer literal_value_type;
+
+    typedef activity_data additional_data;
+};
+
+template<>
+struct ConstraintTraits<ConstraintTypePseudoBoolean> {
+    static size_t minLiterals()    { return 2;    }
+
+    static const VariableType variableType = TypeInteger;
+
+    typedef PseudoBooleanConstraintLiteral literal_type;
+    typedef SplitLiteralArray<literal_type, boost::int32_t> literal_storage;
+    typedef Integer64 constant_type;
+    typedef Integer literal_value_type;
+
+    typedef watched_sum_data additional_data;
 };
 
 class ConstraintManager;
@@ -476,6 +753,8 @@ public:
     typedef typename constraint_traits::constant_type constant_type;
     /** Type of the literals */
     typedef typename constraint_traits::literal_type literal_type;
+    /** Layout of the literals in memory */
+    typedef typename constraint_traits::literal_storage literal_storage;
     /** Type of the additional data */
     typedef typename constraint_traits::additional_data additional_data;
 
@@ -487,6 +766,8 @@ private:
     unsigned d_learnt  :  1;
     /** Did this constraint get deleted */
     unsigned d_deleted :  1;
+    /** Did this constraint get moved by garbage collection (then it holds the forwarding reference) */
+    unsigned d_moved   :  1;
     /** The size of the constraint */
     unsigned d_size    : 31;
     /** Number of times this constraint is currently used as an explanation */
@@ -501,26 +782,29 @@ private:
     /** The additional data */
     additional_data d_additional_data;
 
-    /* The literals  */
+    /* The memory of the literals, laid out by the literal storage  */
     literal_type d_literals[];
 
 public:
 
     /** Constructor with constant */
     TypedConstraint(const std::vector<literal_type>& lits, const constant_type& constant, bool learnt)
-    : d_learnt(learnt ? 1 : 0), d_deleted(0), d_size(lits.size()), d_users(0), d_score(0), d_constant(constant) {
+    : d_learnt(learnt ? 1 : 0), d_deleted(0), d_moved(0), d_size(lits.size()), d_users(0), d_score(0), d_constant(constant) {
         assert(lits.size() >= constraint_traits::minLiterals());
         assert(lits.size() == d_size); // Overflow check
-        for (unsigned i = 0; i < lits.size(); ++i) {
-            new (d_literals + i) literal_type(lits[i]);
-        }
+        getLiterals().construct(lits);
     }
 
     /** Destructor */
     ~TypedConstraint() {
-    	for (unsigned i = 0; i < d_size; ++i) {
-    		d_literals[i].~literal_type();
-    	}
+    	getLiterals().destruct();
+    }
+
+    /**
+     * Returns the size of the memory needed for a constraint with the given number of literals.
+     */
+    static size_t getMemorySize(size_t size) {
+        return sizeof(TypedConstraint) + literal_storage::getMemorySize(size);
     }
 
     void setScore(double value) {
@@ -590,6 +874,13 @@ public:
         d_deleted = deleted ? 1 : 0;
     }
 
+    /**
+     * Returns whether the constraint has been moved by garbage collection.
+     */
+    bool isMoved() const {
+        return d_moved == 1;
+    }
+
     /**
      * Return the type of the constraint.
      */
@@ -600,12 +891,26 @@ public:
     /**
      * Returns the literal at specified position.
      */
-    literal_type& getLiteral(size_t index);
+    typename literal_storage::reference getLiteral(size_t index);
 
     /**
      * Returns the literal at specified position.
      */
-    const literal_type& getLiteral(size_t index) const;
+    typename literal_storage::const_reference getLiteral(size_t index) const;
+
+    /**
+     * Returns the literals as laid out in memory.
+     */
+    literal_storage getLiterals() {
+        return literal_storage(d_literals, d_size);
+    }
+
+    /**
+     * Returns the literals as laid out in memory.
+     */
+    const literal_storage getLiterals() const {
+        return literal_storage(const_cast<literal_type*>(d_literals), d_size);
+    }
 
     /**
      * Returns the constant
@@ -622,7 +927,7 @@ public:
         out << constraintType << "[";
         for (unsigned i = 0; i < d_size; ++ i) {
             if (i > 0) out << ",";
-            out << d_literals[i];
+            out << getLiteral(i);
         }
         out << ":" << d_constant << "]";
     }
@@ -634,7 +939,7 @@ public:
         	out << "(>= (+";
             for (unsigned i = 0; i < d_size; ++ i) {
             	out << " ";
-                d_literals[i].print(out, resolver, format);
+                getLiteral(i).print(out, resolver, format);
             }
             if (d_constant >= 0) {
             	out << ") " << d_constant << ")";
@@ -647,7 +952,7 @@ public:
                 out << "(>= (+";
             for (unsigned i = 0; i < d_size; ++ i) {
                 out << " ";
-                d_literals[i].print(out, resolver, format);
+                getLiteral(i).print(out, resolver, format);
             }
             if (d_constant >= 0) {
                 out << ") " << d_constant << ")";
@@ -658,7 +963,7 @@ public:
         }
         if (format == OutputFormatCnf) {
         	for (unsigned i = 0; i < d_size; ++ i) {
-        		d_literals[i].print(out, resolver, format);
+        		getLiteral(i).print(out, resolver, format);
         		out << " ";
         	}
         	out << " 0";
@@ -667,7 +972,7 @@ public:
     	out << constraintType << "[";
         for (unsigned i = 0; i < d_size; ++ i) {
             if (i > 0) out << " + ";
-            d_literals[i].print(out, resolver, format);
+            getLiteral(i).print(out, resolver, format);
         }
         out << " >= " << d_constant << "]";
     }
@@ -675,9 +980,7 @@ public:
     void swapLiterals(unsigned i, unsigned j) {
         assert(i < d_size && j < d_size);
         if (i == j) return;
-        literal_type tmp = d_literals[i];
-        d_literals[i] = d_literals[j];
-        d_literals[j] = tmp;
+        getLiterals().swap(i, j);
     }
 
     additional_data& getAdditionalData() {
@@ -690,7 +993,7 @@ public:
 
     template<typename T>
     void sort(const T& cmp) {
-    	std::sort(d_literals, d_literals + d_size, cmp);
+    	getLiterals().sort(cmp);
     }
 
     /**
@@ -700,6 +1003,28 @@ public:
      */
     template <class State>
     bool isSatisfied(const State& state) const;
+
+private:
+
+    /**
+     * Marks the constraint as moved to the given reference. The reference is kept in place of the score
+     * and the constant, so this should only be done to the old copy of the constraint.
+     */
+    void setForward(boost::uint64_t forward) {
+        assert((const char*)(this + 1) - (const char*)&d_score >= (std::ptrdiff_t) sizeof(forward));
+        d_moved = 1;
+        std::memcpy(&d_score, &forward, sizeof(forward));
+    }
+
+    /**
+     * Returns the reference the constraint has been moved to.
+     */
+    boost::uint64_t getForward() const {
+        assert(isMoved());
+        boost::uint64_t forward;
+        std::memcpy(&forward, &d_score, sizeof(forward));
+        return forward;
+    }
 };
 
 template<ConstraintType constraintType>
@@ -709,15 +1034,15 @@ std::ostream& operator << (std::ostream& out, const TypedConstraint<constraintTy
 }
 
 template<ConstraintType constraintType>
-typename TypedConstraint<constraintType>::literal_type& TypedConstraint<constraintType>::getLiteral(size_t i) {
+typename TypedConstraint<constraintType>::literal_storage::reference TypedConstraint<constraintType>::getLiteral(size_t i) {
     assert(i < d_size);
-    return d_literals[i];
+    return getLiterals()[i];
 }
 
 template<ConstraintType constraintType>
-typename TypedConstraint<constraintType>::literal_type const& TypedConstraint<constraintType>::getLiteral(size_t i) const {
+typename TypedConstraint<constraintType>::literal_storage::const_reference TypedConstraint<constraintType>::getLiteral(size_t i) const {
     assert(i < d_size);
-    return d_literals[i];
+    return getLiterals()[i];
 }
 
 template<ConstraintType constraintType>
@@ -759,7 +1084,31 @@ bool TypedConstraint<ConstraintTypeInteger>::isSatisfied(const State& state) con
     CUTSAT_TRACE("constraints::check") << *this << std::endl;
 	Integer sum = 0;
     for (unsigned i = 0; i < d_size; ++ i) {
-        sum += state.template getCurrentValue<ConstraintTypeInteger>(d_literals[i]);
+        sum += state.template getCurrentValue<ConstraintTypeInteger>(getLiteral(i));
+    }
+    CUTSAT_TRACE("constraints::check") << "LHS: " << sum << ", RHS: " << d_constant << std::endl;
+    return sum >= d_constant;
+}
+
+template<>
+template<class State>
+bool TypedConstraint<ConstraintTypeInteger64>::isSatisfied(const State& state) const {
+    CUTSAT_TRACE("constraints::check") << *this << std::endl;
+	Integer sum = 0;
+    for (unsigned i = 0; i < d_size; ++ i) {
+        sum += state.template getCurrentValue<ConstraintTypeInteger64>(getLiteral(i));
+    }
+    CUTSAT_TRACE("constraints::check") << "LHS: " << sum << ", RHS: " << d_constant << std::endl;
+    return sum >= d_constant;
+}
+
+template<>
+template<class State>
+bool TypedConstraint<ConstraintTypePseudoBoolean>::isSatisfied(const State& state) const {
+    CUTSAT_TRACE("constraints::check") << *this << std::endl;
+	Integer sum = 0;
+    for (unsigned i = 0; i < d_size; ++ i) {
+        sum += state.template getCurrentValue<ConstraintTypePseudoBoolean>(getLiteral(i));
     }
     CUTSAT_TRACE("constraints::check") << "LHS: " << sum << ", RHS: " << d_constant << std::endl;
     return sum >= d_constant;
@@ -768,5 +1117,93 @@ bool TypedConstraint<ConstraintTypeInteger>::isSatisfied(const State& state) con
 typedef TypedConstraint<ConstraintTypeClause> ClauseConstraint;
 typedef TypedConstraint<ConstraintTypeCardinality> CardinalityConstraint;
 typedef TypedConstraint<ConstraintTypeInteger> IntegerConstraint;
+typedef TypedConstraint<ConstraintTypeInteger64> Integer64Constraint;
+typedef TypedConstraint<ConstraintTypePseudoBoolean> PseudoBooleanConstraint;
+
+/**
+ * A binary clause of the problem. These are not allocated in the constraint memory, the clause propagator
+ * keeps them as implications in the watch lists and the constraint manager keeps the two literals, so that
+ * the clause can be looked up when it is the reason of a propagation.
+ */
+class BinaryClause {
+
+    /** The two literals */
+    ClauseConstraintLiteral d_literals[2];
+
+public:
+
+    BinaryClause(ClauseConstraintLiteral l0, ClauseConstraintLiteral l1) {
+        d_literals[0] = l0;
+        d_literals[1] = l1;
+    }
+
+    size_t getSize() const {
+        return 2;
+    }
+
+    const ClauseConstraintLiteral& getLiteral(size_t i) const {
+        assert(i < 2);
+        return d_literals[i];
+    }
+
+    /** Returns the constant, as it would be in the clause constraint */
+    int getConstant() const {
+        return 1 - (d_literals[0].isNegated() ? 1 : 0) - (d_literals[1].isNegated() ? 1 : 0);
+    }
+
+    /** Prints the constraint to the stream */
+    void print(std::ostream& out, OutputFormat format) const {
+        out << ConstraintTypeClause << "[" << d_literals[0] << "," << d_literals[1] << ":" << getConstant() << "]";
+    }
+
+    /** Prints the constraint to the stream */
+    template<class VariableResolver>
+    void print(std::ostream& out, const VariableResolver& resolver, OutputFormat format) const {
+        switch (format) {
+        case OutputFormatSmt:
+        case OutputFormatSmt2:
+            out << "(>= (+ ";
+            d_literals[0].print(out, resolver, format);
+            out << " ";
+            d_literals[1].print(out, resolver, format);
+            if (getConstant() >= 0) {
+                out << ") " << getConstant() << ")";
+            } else {
+                out << (format == OutputFormatSmt ? ") (~ " : ") (- ") << -getConstant() << "))";
+            }
+            break;
+        case OutputFormatCnf:
+            d_literals[0].print(out, resolver, format);
+            out << " ";
+            d_literals[1].print(out, resolver, format);
+            out << "  0";
+            break;
+        default:
+            out << ConstraintTypeClause << "[";
+            d_literals[0].print(out, resolver, format);
+            out << " + ";
+            d_literals[1].print(out, resolver, format);
+            out << " >= " << getConstant() << "]";
+            break;
+        }
+    }
+
+    /**
+     * Check if the constraint is satisfied in the given state.
+     * @param state
+     * @return true if the constraint is satisfied
+     */
+    template <class State>
+    bool isSatisfied(const State& state) const {
+        return
+            state.template getCurrentValue<ConstraintTypeClause>(d_literals[0]) == 1 ||
+            state.template getCurrentValue<ConstraintTypeClause>(d_literals[1]) == 1;
+    }
+};
+
+inline std::ostream& operator << (std::ostream& out, const BinaryClause& clause) {
+    clause.print(out, OutputFormatIlp);
+    return out;
+}
 
 }
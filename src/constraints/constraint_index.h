@@ -0,0 +1,192 @@
+/**
+ * Copyright 2010 Dejan Jovanovic.
+ *
+ * This file is part of cutsat.
+ *
+ * Cutsat is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cutsat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cutsat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "constraints/constraint_manager.h"
+
+namespace cutsat {
+
+/**
+ * Hash index of the integer constraints, keyed by their literals and the constant, so that a
+ * constraint that is already in the database can be found instead of being created again. The
+ * literals should be normalized (sorted) the same way when inserting and searching.
+ */
+class ConstraintIndex {
+
+    typedef boost::unordered_multimap<size_t, ConstraintRef> index_map;
+
+    /** Constraints indexed by their hash */
+    index_map d_index;
+
+    /** The constraint manager */
+    const ConstraintManager& d_cm;
+
+    /** Number of times a constraint was found */
+    unsigned d_duplicates;
+
+    static size_t hashValue(const Integer& value) {
+        // Big values all go to the same bucket, they are rare
+        return value.isSmall() ? boost::hash_value(value.getSmall()) : 0;
+    }
+
+    static size_t hashValue(Integer64 value) {
+        return boost::hash_value(value);
+    }
+
+    /** The hash doesn't depend on the order of the literals, as the propagators reorder them */
+    template<typename LiteralStorage, typename Constant>
+    static size_t hash(const LiteralStorage& literals, size_t size, const Constant& constant) {
+        size_t seed = hashValue(constant);
+        for (unsigned i = 0; i < size; ++ i) {
+            size_t literalHash = 0;
+            boost::hash_combine(literalHash, literals.getVariable(i).getId());
+            boost::hash_combine(literalHash, hashValue(literals.getCoefficient(i)));
+            seed += literalHash;
+        }
+        return seed;
+    }
+
+    /** Compares the literals by variable */
+    struct LiteralVariableCmp {
+        bool operator () (const IntegerConstraintLiteral& literal, Variable var) const {
+            return literal.getVariable().getId() < var.getId();
+        }
+    };
+
+    template<ConstraintType type>
+    size_t hashConstraint(ConstraintRef constraintRef) const {
+        const TypedConstraint<type>& constraint = d_cm.get<type>(constraintRef);
+        return hash(constraint.getLiterals(), constraint.getSize(), constraint.getConstant());
+    }
+
+    size_t hashConstraint(ConstraintRef constraintRef) const {
+        switch (ConstraintManager::getType(constraintRef)) {
+        case ConstraintTypeInteger:
+            return hashConstraint<ConstraintTypeInteger>(constraintRef);
+        case ConstraintTypeInteger64:
+            return hashConstraint<ConstraintTypeInteger64>(constraintRef);
+        default:
+            assert(false);
+            return 0;
+        }
+    }
+
+    template<ConstraintType type>
+    bool equals(ConstraintRef constraintRef, const std::vector<IntegerConstraintLiteral>& literals, const Integer& constant) const {
+        const TypedConstraint<type>& constraint = d_cm.get<type>(constraintRef);
+        if (constraint.isDeleted() || constraint.getSize() != literals.size() || constraint.getConstant() != constant) {
+            return false;
+        }
+        // The literals are sorted by variable, but the ones in the constraint might have been reordered
+        const typename TypedConstraint<type>::literal_storage constraintLiterals = constraint.getLiterals();
+        for (unsigned i = 0; i < literals.size(); ++ i) {
+            Variable var = constraintLiterals.getVariable(i);
+            std::vector<IntegerConstraintLiteral>::const_iterator find = std::lower_bound(literals.begin(), literals.end(), var, LiteralVariableCmp());
+            if (find == literals.end() || find->getVariable() != var || find->getCoefficient() != constraintLiterals.getCoefficient(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Vector of literals with the same interface as the literals of the constraint */
+    struct LiteralVector {
+        const std::vector<IntegerConstraintLiteral>& literals;
+        LiteralVector(const std::vector<IntegerConstraintLiteral>& literals)
+        : literals(literals) {}
+        Variable getVariable(size_t i) const {
+            return literals[i].getVariable();
+        }
+        const Integer& getCoefficient(size_t i) const {
+            return literals[i].getCoefficient();
+        }
+    };
+
+public:
+
+    ConstraintIndex(const ConstraintManager& cm)
+    : d_cm(cm), d_duplicates(0) {}
+
+    /**
+     * Adds the (integer) constraint to the index.
+     */
+    void insert(ConstraintRef constraintRef) {
+        d_index.insert(index_map::value_type(hashConstraint(constraintRef), constraintRef));
+    }
+
+    /**
+     * Removes the constraint from the index (call before erasing the constraint).
+     */
+    void erase(ConstraintRef constraintRef) {
+        std::pair<index_map::iterator, index_map::iterator> range = d_index.equal_range(hashConstraint(constraintRef));
+        for (; range.first != range.second; ++ range.first) {
+            if (range.first->second == constraintRef) {
+                d_index.erase(range.first);
+                return;
+            }
+        }
+    }
+
+    /**
+     * Returns the constraint with the given literals and constant, or NullConstraint if there is
+     * none. Each found constraint is counted as a duplicate.
+     */
+    ConstraintRef find(const std::vector<IntegerConstraintLiteral>& literals, const Integer& constant) {
+        std::pair<index_map::const_iterator, index_map::const_iterator> range = d_index.equal_range(hash(LiteralVector(literals), literals.size(), constant));
+        for (; range.first != range.second; ++ range.first) {
+            ConstraintRef constraintRef = range.first->second;
+            bool found = ConstraintManager::getType(constraintRef) == ConstraintTypeInteger ?
+                    equals<ConstraintTypeInteger>(constraintRef, literals, constant) :
+                    equals<ConstraintTypeInteger64>(constraintRef, literals, constant);
+            if (found) {
+                ++ d_duplicates;
+                return constraintRef;
+            }
+        }
+        return ConstraintManager::NullConstraint;
+    }
+
+    /**
+     * Returns the number of duplicates found.
+     */
+    unsigned getDuplicates() const {
+        return d_duplicates;
+    }
+
+    /**
+     * Updates the constraints after garbage collection (before gcEnd()).
+     */
+    void gcUpdate() {
+        index_map::iterator it = d_index.begin();
+        index_map::iterator it_end = d_index.end();
+        for (; it != it_end; ++ it) {
+            it->second = d_cm.gcRelocate(it->second);
+        }
+    }
+};
+
+}
@@ -27,11 +27,11 @@ using namespace cutsat;
 
 TraceTag constraints("constraints");
 
-ConstraintManager::ConstraintManager(size_t initialSize)
-: d_capacity(initialSize), d_size(0), d_variablesCount(0) {
-    // Initialize all the memory
-    d_memory = (char*)std::malloc(s_initialSize);
-    d_wasted   = 0;
+ConstraintManager::ConstraintManager(size_t segmentSize)
+: d_segmentSize(segmentSize), d_wasted(0), d_variablesCount(0) {
+
+    // All the offsets in a segment must fit into the index (the bigger ones only have the constraint at 0)
+    assert(align(segmentSize) >> s_word_bits <= s_offset_mask + 1);
 
     CUTSAT_TRACE("constraints") << "Data bits: " << s_data_bits << std::endl;
     CUTSAT_TRACE("constraints") << "Type mask: " << s_type_mask << std::endl;
@@ -45,12 +45,52 @@ Variable ConstraintManager::newVariable(VariableType type) {
     return newVariable;
 }
 
+ConstraintManager::ConstraintRef ConstraintManager::newBinaryClause(ClauseConstraintLiteral l0, ClauseConstraintLiteral l1) {
+
+    CUTSAT_TRACE("constraints") << "newBinaryClause(" << l0 << "," << l1 << ")" << std::endl;
+
+    // The index must fit into the reference
+    if (d_binaryClauses.size() >= ((size_t)1 << (8*sizeof(ConstraintRef) - s_data_bits)) - 1) {
+        throw CutSatException("out of constraint memory!");
+    }
+
+    size_t index = d_binaryClauses.size();
+    d_binaryClauses.push_back(BinaryClause(l0, l1));
+
+    // Count the variables
+    for (unsigned i = 0; i < 2; ++ i) {
+        const ClauseConstraintLiteral& literal = d_binaryClauses.back().getLiteral(i);
+        if (literal.isNegated()) {
+            d_variableOccursCount[2*literal.getVariable().getId()] ++;
+        } else {
+            d_variableOccursCount[2*literal.getVariable().getId() + 1] ++;
+        }
+    }
+
+    return getConstraintRef(ConstraintTypeBinaryClause, index);
+}
+
+ConstraintManager::~ConstraintManager() {
+    freeRegion(d_problemRegion);
+    freeRegion(d_learntRegion);
+    freeRegion(d_gcRegion);
+}
+
+void ConstraintManager::freeRegion(Region& region) {
+    for (unsigned i = 0; i < region.segments.size(); ++ i) {
+        size_t segmentId = region.segments[i];
+        std::free(d_segments[segmentId]);
+        d_segments[segmentId] = NULL;
+        d_freeSegments.push_back(segmentId);
+    }
+    region = Region();
+}
+
 void ConstraintManager::gcBegin() {
-	d_gcMemory = (char*)malloc(d_capacity);
-	d_gcSize = 0;
+	freeRegion(d_gcRegion);
 }
 
-void ConstraintManager::gcMove(std::vector<ConstraintRef>& constraints, std::map<ConstraintRef, ConstraintRef>& reallocMap) {
+void ConstraintManager::gcMove(std::vector<ConstraintRef>& constraints) {
 	for(unsigned i = 0, i_end = constraints.size(); i < i_end; ++ i) {
 		// Old constraint
 		ConstraintRef oldConstraintRef = constraints[i];
@@ -58,30 +98,49 @@ void ConstraintManager::gcMove(std::vector<ConstraintRef>& constraints, std::map
 			continue;
 		}
 		assert(!getFlag(oldConstraintRef));
-		unsigned index = getIndex(oldConstraintRef);
+		size_t index = getIndex(oldConstraintRef);
+
+		// Problem constraints stay where they are
+		ClauseConstraint& oldConstraint = get<ConstraintTypeClause>(oldConstraintRef);
+		if (!oldConstraint.isLearnt()) {
+			continue;
+		}
+		// Already moved from another list
+		if (oldConstraint.isMoved()) {
+			constraints[i] = oldConstraint.getForward();
+			continue;
+		}
 
 		// Size of the constraint
 		size_t size = 0;
 		ConstraintType type = getType(oldConstraintRef);
 		switch (type) {
         case ConstraintTypeClause:
-            size = sizeof(ClauseConstraint) + sizeof(ClauseConstraintLiteral)*get<ConstraintTypeClause>(oldConstraintRef).getSize();
+            size = ClauseConstraint::getMemorySize(get<ConstraintTypeClause>(oldConstraintRef).getSize());
+            break;
+        case ConstraintTypeCardinality:
+            size = CardinalityConstraint::getMemorySize(get<ConstraintTypeCardinality>(oldConstraintRef).getSize());
             break;
 		case ConstraintTypeInteger:
-			size = sizeof(IntegerConstraint) + sizeof(IntegerConstraintLiteral)*get<ConstraintTypeInteger>(oldConstraintRef).getSize();
+			size = IntegerConstraint::getMemorySize(get<ConstraintTypeInteger>(oldConstraintRef).getSize());
+			break;
+		case ConstraintTypeInteger64:
+			size = Integer64Constraint::getMemorySize(get<ConstraintTypeInteger64>(oldConstraintRef).getSize());
+			break;
+		case ConstraintTypePseudoBoolean:
+			size = PseudoBooleanConstraint::getMemorySize(get<ConstraintTypePseudoBoolean>(oldConstraintRef).getSize());
 			break;
 		default:
 			assert(false);
 		}
 		size = align(size);
 		// Move the memory
-		memcpy(d_gcMemory + d_gcSize, d_memory + index, size);
+		size_t newIndex = allocate(d_gcRegion, size);
+		memcpy(getMemory(newIndex), getMemory(index), size);
         // The new reference
-        ConstraintRef newConstraintRef = getConstraintRef(type, d_gcSize);
-		// Add to the realloc map
-		reallocMap[oldConstraintRef] = newConstraintRef;
-		// Adjust the new size
-		d_gcSize += size;
+        ConstraintRef newConstraintRef = getConstraintRef(type, newIndex);
+		// Leave the forwarding reference in the old copy
+		oldConstraint.setForward(newConstraintRef);
 
         // Replace in the list
         constraints[i] = newConstraintRef;
@@ -89,9 +148,7 @@ void ConstraintManager::gcMove(std::vector<ConstraintRef>& constraints, std::map
 }
 
 void ConstraintManager::gcEnd() {
-	free(d_memory);
-	d_memory = d_gcMemory;
-	d_size = d_gcSize;
+	freeRegion(d_learntRegion);
+	std::swap(d_learntRegion, d_gcRegion);
 	d_wasted = 0;
-	d_gcMemory = NULL;
 }
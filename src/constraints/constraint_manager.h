@@ -35,36 +35,85 @@ namespace cutsat {
 
 /**
  * Constraint manager allocates the memory on demand expanding the memory. The amount of wasted
- * memory is kept so that the user decide if she wants to do a garbage-collection sweep.
+ * memory is kept so that the user decide if she wants to do a garbage-collection sweep. The memory
+ * is a list of segments that never move, so growing doesn't copy the constraints. Problem and learnt
+ * constraints are kept in separate regions, and garbage collection only compacts the learnt one.
  */
 class ConstraintManager {
 
 public:
 
-    /** The reference to a constraint */
+    /** The reference to a constraint (32 bits address 2GB of constraints, unless built with wide references) */
+#ifdef CUTSAT_WIDE_CONSTRAINT_REFS
     typedef boost::uint64_t ConstraintRef;
+#else
+    typedef boost::uint32_t ConstraintRef;
+#endif
 
     /** The null constraint */
     static const ConstraintRef NullConstraint = boost::integer_traits<ConstraintRef>::const_max;
 
 private:
 
-    /** Pointer to the memory */
-    char* d_memory;
+    /** Constraints are aligned to words of 8 bytes, and the offsets in the segments count the words */
+    static const size_t s_word_bits = 3;
 
-    /** Pointer to the new memory when doing garbage collection */
-    char* d_gcMemory;
+    /** Bits of the memory index used for the offset (in words) in the segment */
+#ifdef CUTSAT_WIDE_CONSTRAINT_REFS
+    static const size_t s_offset_bits = 32;
+#else
+    static const size_t s_offset_bits = 19;
+#endif
 
-    /** Current capacity of each memory */
-    size_t d_capacity;
+    /** Mask to extract the offset in the segment */
+    static const size_t s_offset_mask = ((size_t)1 << s_offset_bits) - 1;
 
-    /** Current size of each memory */
-    size_t d_size;
+    /**
+     * A region of the memory, made of segments. Constraints that don't fit into a segment get their own.
+     */
+    struct Region {
+
+        /** The segments of this region */
+        std::vector<size_t> segments;
+
+        /** Used size of the last segment */
+        size_t lastSize;
+
+        /** Capacity of the last segment */
+        size_t lastCapacity;
 
-    /** Size of the new memory when doing garbage collection */
-    size_t d_gcSize;
+        /** Total used size */
+        size_t size;
+
+        /** Total capacity */
+        size_t capacity;
+
+        Region()
+        : lastSize(0), lastCapacity(0), size(0), capacity(0) {}
+    };
+
+    /**
+     * All the segments, the index of the memory is the segment in the upper bits and the offset in the
+     * segment in the lower bits.
+     */
+    std::vector<char*> d_segments;
 
-    /** The current total wasted memory */
+    /** Free slots in the segment table */
+    std::vector<size_t> d_freeSegments;
+
+    /** Size of a new segment */
+    size_t d_segmentSize;
+
+    /** The problem constraints, these are never collected */
+    Region d_problemRegion;
+
+    /** The learnt constraints */
+    Region d_learntRegion;
+
+    /** The new learnt region when doing garbage collection */
+    Region d_gcRegion;
+
+    /** The current total wasted memory (in the learnt region) */
     size_t d_wasted;
 
     /** How many variables we have */
@@ -73,8 +122,11 @@ private:
     /** Count for each pair (variable, polarity) in how many constraint it appears in */
     std::vector<unsigned> d_variableOccursCount;
 
-    /** Default initial size for each of the memories */
-    static const size_t s_initialSize = 100000;
+    /** The binary problem clauses, these are kept outside of the constraint memory */
+    std::vector<BinaryClause> d_binaryClauses;
+
+    /** Default size of the memory segments */
+    static const size_t s_segmentSize = 1 << 22;
 
     /** We have one additional bit for any application specific data */
     static const size_t s_type_bits = 3;
@@ -88,7 +140,10 @@ private:
     /** Mask to extract the flag bits */
     static const boost::uint32_t s_flag_mask = (1 << s_type_bits);
 
-    inline unsigned align(unsigned size) {
+    /** Maximal number of segments, so that the index fits into the reference */
+    static const size_t s_segments_max = (size_t)1 << (8*sizeof(ConstraintRef) - s_data_bits - s_offset_bits);
+
+    inline static size_t align(size_t size) {
     	return (size + 7) & ~((size_t)7);
     }
 
@@ -97,14 +152,6 @@ private:
         return ref >> s_data_bits;
     }
 
-    /**
-     * Returns the reference, given a constraint pointer and a type. This is used when allocating
-     * new memory
-     */
-    inline ConstraintRef getConstraintRef(ConstraintType type, const char* cPtr) const {
-        return  ((ConstraintRef)(cPtr - d_memory) << s_data_bits) | type;
-    }
-
     /**
      * Returns the reference, given the index into memory a type. This is used when allocating
      * new memory
@@ -116,11 +163,19 @@ private:
 public:
 
     /**
-     * Create a new constraint given the variables (constant = 0).
+     * Create a new constraint given the variables (constant = 0). Integer constraints with all the
+     * coefficients and the constant fitting into a native word are created as ConstraintTypeInteger64,
+     * so check the type of the returned reference.
      */
     template <ConstraintType type>
     ConstraintRef newConstraint(const std::vector< Literal<type> >& literals, const typename ConstraintTraits<type>::constant_type& constant = 0, bool learnt = false);
 
+    /**
+     * Create a new binary problem clause. The clause is not allocated in the constraint memory, the
+     * reference (of type ConstraintTypeBinaryClause) just indexes the two literals.
+     */
+    ConstraintRef newBinaryClause(ClauseConstraintLiteral l0, ClauseConstraintLiteral l1);
+
     /**
      * Erase the given constraint.
      */
@@ -141,14 +196,23 @@ public:
     /**
      * Creates a constraint manager.
      */
-    ConstraintManager(size_t initialSize = s_initialSize);
+    ConstraintManager(size_t segmentSize = s_segmentSize);
+
+    /**
+     * Frees all the memory.
+     */
+    ~ConstraintManager();
 
     size_t getSize() const {
-        return d_size;
+        return d_problemRegion.size + d_learntRegion.size;
     }
 
     size_t getCapacity() const {
-        return d_capacity;
+        return d_problemRegion.capacity + d_learntRegion.capacity;
+    }
+
+    size_t getLearntSize() const {
+        return d_learntRegion.size;
     }
 
     size_t getWasted() const {
@@ -167,7 +231,15 @@ public:
      */
     template <ConstraintType type>
     TypedConstraint<type>& get(ConstraintRef ref) const {
-        return *((TypedConstraint<type>*) (d_memory + getIndex(ref)));
+        return *((TypedConstraint<type>*) getMemory(getIndex(ref)));
+    }
+
+    /**
+     * Returns the binary clause pointed to by the reference.
+     */
+    const BinaryClause& getBinaryClause(ConstraintRef ref) const {
+        assert(isBinaryClause(ref));
+        return d_binaryClauses[getIndex(ref)];
     }
 
     /** Returns the type of the constraint given the reference */
@@ -175,6 +247,11 @@ public:
         return static_cast<ConstraintType>(ref & s_type_mask);
     }
 
+    /** Returns true if the reference is a binary clause, i.e. it doesn't point into the constraint memory */
+    inline static bool isBinaryClause(ConstraintRef ref) {
+        return getType(ref) == ConstraintTypeBinaryClause;
+    }
+
     inline static ConstraintRef setFlag(ConstraintRef constraintRef) {
     	return constraintRef | s_flag_mask;
     }
@@ -187,17 +264,54 @@ public:
     	return constraintRef & s_flag_mask;
     }
 
+    /**
+     * Garbage collection of the learnt constraints. Problem constraints are never moved, so gcMove()
+     * skips them and they keep their references. The old copy of a moved constraint keeps the forwarding
+     * reference until gcEnd(), so all references should be relocated before that.
+     */
     void gcBegin();
-    void gcMove(std::vector<ConstraintRef>& constraints, std::map<ConstraintRef, ConstraintRef>& reallocMap);
+    void gcMove(std::vector<ConstraintRef>& constraints);
     void gcEnd();
 
+    /**
+     * Returns the reference of the constraint after garbage collection (with the flag kept).
+     */
+    inline ConstraintRef gcRelocate(ConstraintRef constraintRef) const {
+        if (isBinaryClause(constraintRef)) {
+            return constraintRef;
+        }
+        const ClauseConstraint& constraint = get<ConstraintTypeClause>(constraintRef);
+        if (!constraint.isMoved()) {
+            return constraintRef;
+        }
+        return getFlag(constraintRef) ? setFlag(constraint.getForward()) : constraint.getForward();
+    }
+
 private:
 
     /**
-     * Allocate a new bloc of a given size in the given memory.
+     * Construct the constraint of the given type in new memory.
      */
     template <ConstraintType type>
-    inline char* allocate(size_t size);
+    ConstraintRef constructConstraint(const std::vector< Literal<type> >& literals, const typename ConstraintTraits<type>::constant_type& constant, bool learnt);
+
+    /**
+     * Allocate a block of the (aligned) size in the region, returns the index.
+     */
+    inline size_t allocate(Region& region, size_t size);
+
+    /**
+     * Returns the memory at the given index.
+     */
+    inline char* getMemory(size_t index) const {
+        return d_segments[index >> s_offset_bits] + ((index & s_offset_mask) << s_word_bits);
+    }
+
+    /**
+     * Free all the segments of the region.
+     */
+    void freeRegion(Region& region);
+
 };
 
 /**
@@ -209,14 +323,44 @@ typedef ConstraintManager::ConstraintRef ConstraintRef;
 template <ConstraintType type>
 ConstraintManager::ConstraintRef ConstraintManager::newConstraint(
         const std::vector< Literal<type> >& lits, const typename ConstraintTraits<type>::constant_type& constant, bool learnt) {
+    return constructConstraint<type>(lits, constant, learnt);
+}
+
+template <>
+inline ConstraintManager::ConstraintRef ConstraintManager::newConstraint<ConstraintTypeInteger>(
+        const std::vector<IntegerConstraintLiteral>& lits, const Integer& constant, bool learnt) {
+
+    // Check if everything fits into the native representation
+    bool native = constant.isSmall();
+    for (unsigned i = 0; native && i < lits.size(); ++ i) {
+        native = lits[i].getCoefficient().isSmall();
+    }
+    if (!native) {
+        return constructConstraint<ConstraintTypeInteger>(lits, constant, learnt);
+    }
+
+    // Convert the literals
+    std::vector<Integer64ConstraintLiteral> nativeLits;
+    nativeLits.reserve(lits.size());
+    for (unsigned i = 0; i < lits.size(); ++ i) {
+        nativeLits.push_back(Integer64ConstraintLiteral(lits[i].getCoefficient().getSmall(), lits[i].getVariable()));
+    }
+    return constructConstraint<ConstraintTypeInteger64>(nativeLits, constant.getSmall(), learnt);
+}
+
+template <ConstraintType type>
+ConstraintManager::ConstraintRef ConstraintManager::constructConstraint(
+        const std::vector< Literal<type> >& lits, const typename ConstraintTraits<type>::constant_type& constant, bool learnt) {
 
     CUTSAT_TRACE("constraints") << "newConstraint(" << lits << "," << constant << ")" << std::endl;
 
-    // Compute the size (this should be safe as variant puts the template data at the end)
-    size_t size = sizeof(TypedConstraint<type>) + sizeof(typename TypedConstraint<type>::literal_type)*lits.size();
+    // Compute the size
+    size_t size = TypedConstraint<type>::getMemorySize(lits.size());
 
     // Allocate the memory
-    char* memory = allocate<type>(size);
+    CUTSAT_TRACE("constraints") << "allocate(" << size << ")" << std::endl;
+    size_t index = allocate(learnt ? d_learntRegion : d_problemRegion, align(size));
+    char* memory = getMemory(index);
 
     // Initialize the constraint
     TypedConstraint<type>* constraint = new (memory) TypedConstraint<type>(lits, constant, learnt);
@@ -232,42 +376,45 @@ ConstraintManager::ConstraintRef ConstraintManager::newConstraint(
 
     CUTSAT_TRACE("constraints") << "newConstraint() => " << *constraint << std::endl;
 
-    return getConstraintRef(type, memory);
+    return getConstraintRef(type, index);
 }
 
-template <ConstraintType type>
-inline char* ConstraintManager::allocate(size_t size) {
-
-    CUTSAT_TRACE("constraints") << "allocate(" << size << ")" << std::endl;
-
-    // The memory we are dealing with
-    // Align the size
-    size = align(size);
-    // Ensure enough capacity
-    size_t requested = d_size + size;
-    if (requested > d_capacity) {
-        while (requested > d_capacity) {
-            d_capacity += d_capacity >> 1;
+inline size_t ConstraintManager::allocate(Region& region, size_t size) {
+    if (region.lastSize + size > region.lastCapacity) {
+        // New segment, the rest of the last one stays unused
+        if (d_freeSegments.empty() && d_segments.size() == s_segments_max) {
+            throw CutSatException("out of constraint memory!");
         }
-        // Reallocate the memory
-        d_memory = (char*)std::realloc(d_memory, d_capacity);
-        if (d_memory == NULL) {
-        	throw CutSatException("out of memory!");
+        size_t capacity = std::max(d_segmentSize, size);
+        char* segment = (char*)std::malloc(capacity);
+        if (segment == NULL) {
+            throw CutSatException("out of memory!");
         }
+        size_t segmentId;
+        if (d_freeSegments.empty()) {
+            segmentId = d_segments.size();
+            d_segments.push_back(segment);
+        } else {
+            segmentId = d_freeSegments.back();
+            d_freeSegments.pop_back();
+            d_segments[segmentId] = segment;
+        }
+        region.segments.push_back(segmentId);
+        region.lastSize = 0;
+        region.lastCapacity = capacity;
+        region.capacity += capacity;
     }
-    // The pointer to the new memory
-    char* pointer = d_memory + d_size;
-    // Increase the used size
-    d_size += size;
-    // And that's it
-    return pointer;
+    size_t index = (region.segments.back() << s_offset_bits) | (region.lastSize >> s_word_bits);
+    region.lastSize += size;
+    region.size += size;
+    return index;
 }
 
 template<ConstraintType type>
 inline void ConstraintManager::eraseConstraint(ConstraintRef constraintRef) {
     TypedConstraint<type>& constraint = get<type>(constraintRef);
     assert(!constraint.inUse());
-    size_t size = sizeof(TypedConstraint<type>) + sizeof(typename TypedConstraint<type>::literal_type)*constraint.getSize();
+    size_t size = TypedConstraint<type>::getMemorySize(constraint.getSize());
     for (unsigned i = 0; i < constraint.getSize(); ++ i) {
     	if (constraint.getLiteral(i).isNegated()) {
     		d_variableOccursCount[2*constraint.getLiteral(i).getVariable().getId()] --;
@@ -276,8 +423,10 @@ inline void ConstraintManager::eraseConstraint(ConstraintRef constraintRef) {
     	}
     }
     constraint.setDeleted(true);
-    // Deallocation is just increasing the wasted
-    d_wasted += align(size);
+    // Deallocation is just increasing the wasted (only the learnt region is collected)
+    if (constraint.isLearnt()) {
+        d_wasted += align(size);
+    }
 }
 
 }
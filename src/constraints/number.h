@@ -19,113 +19,813 @@
 
 #pragma once
 
+#if defined(CUTSAT_NUMBERS_GMP) || defined(CUTSAT_NUMBERS_INT128)
+#include <gmpxx.h>
+#else
 #include <cln/io.h>
 #include <cln/integer.h>
 #include <cln/integer_io.h>
 #include <cln/rational.h>
 #include <cln/rational_io.h>
 #include <cln/dfloat.h>
+#endif
 
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cassert>
+#include <ostream>
+
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
 #include <boost/mpl/vector.hpp>
 #include <boost/numeric/conversion/converter.hpp>
 #include <boost/math/common_factor.hpp>
 
+#include "util/exception.h"
+
+#if !defined(CUTSAT_NUMBERS_GMP) && !defined(CUTSAT_NUMBERS_INT128)
 namespace cln {
 extern cl_read_flags cl_I_read_flags;
 extern cl_read_flags cl_RA_read_flags;
 }
+#endif
 
 namespace cutsat {
 
 /** The Boolean type */
 typedef bool Boolean;
 
-/** The integer type */
-typedef cln::cl_I Integer;
-
 /** Native integer type */
 typedef boost::int64_t Integer64;
 
+/** Native unsigned integer type */
+typedef boost::uint64_t UnsignedInteger64;
+
+template <typename Number> struct NumberUtils;
+
+/**
+ * Returns the length of the integer (optional sign followed by digits) at the start of the string.
+ */
+inline unsigned scanInteger(const char* string) {
+    unsigned length = 0;
+    if (string[length] == '-' || string[length] == '+') length ++;
+    unsigned digitsStart = length;
+    while (string[length] >= '0' && string[length] <= '9') length ++;
+    return length > digitsStart ? length : 0;
+}
+
+#if defined(CUTSAT_NUMBERS_INT128)
+
+/**
+ * A 128-bit integer with all the operations checked for overflow. There is no arbitrary precision
+ * to fall back to, so an overflow aborts the solving with an exception.
+ */
+class CheckedInteger128 {
+
+    /** The value */
+    __int128 d_value;
+
+public:
+
+    /** Called when an operation overflows */
+    static void overflow() {
+        throw CutSatException("Integer overflow, the problem needs the cln or gmp number backend.");
+    }
+
+    CheckedInteger128()
+    : d_value(0) {}
+
+    explicit CheckedInteger128(__int128 value)
+    : d_value(value) {}
+
+    /** Get the native value */
+    __int128 getValue() const {
+        return d_value;
+    }
+
+    CheckedInteger128& operator += (const CheckedInteger128& other) {
+        if (__builtin_add_overflow(d_value, other.d_value, &d_value)) overflow();
+        return *this;
+    }
+
+    CheckedInteger128& operator -= (const CheckedInteger128& other) {
+        if (__builtin_sub_overflow(d_value, other.d_value, &d_value)) overflow();
+        return *this;
+    }
+
+    CheckedInteger128& operator *= (const CheckedInteger128& other) {
+        if (__builtin_mul_overflow(d_value, other.d_value, &d_value)) overflow();
+        return *this;
+    }
+
+    CheckedInteger128 operator - () const {
+        __int128 result;
+        if (__builtin_sub_overflow((__int128) 0, d_value, &result)) overflow();
+        return CheckedInteger128(result);
+    }
+
+    /** Divide rounding towards zero, returns the remainder */
+    CheckedInteger128 divide(const CheckedInteger128& other, CheckedInteger128& remainder) const {
+        if (other.d_value == -1) {
+            remainder = CheckedInteger128();
+            return -*this;
+        }
+        remainder = CheckedInteger128(d_value % other.d_value);
+        return CheckedInteger128(d_value / other.d_value);
+    }
+};
+
+inline CheckedInteger128 operator + (const CheckedInteger128& a, const CheckedInteger128& b) {
+    CheckedInteger128 result(a);
+    return result += b;
+}
+
+inline CheckedInteger128 operator - (const CheckedInteger128& a, const CheckedInteger128& b) {
+    CheckedInteger128 result(a);
+    return result -= b;
+}
+
+inline CheckedInteger128 operator * (const CheckedInteger128& a, const CheckedInteger128& b) {
+    CheckedInteger128 result(a);
+    return result *= b;
+}
+
+inline bool operator == (const CheckedInteger128& a, const CheckedInteger128& b) {
+    return a.getValue() == b.getValue();
+}
+
+inline bool operator < (const CheckedInteger128& a, const CheckedInteger128& b) {
+    return a.getValue() < b.getValue();
+}
+
+inline std::ostream& operator << (std::ostream& out, const CheckedInteger128& a) {
+    unsigned __int128 value = a.getValue() < 0 ? -(unsigned __int128) a.getValue() : a.getValue();
+    char digits[41];
+    char* digitsP = digits + sizeof(digits);
+    *--digitsP = 0;
+    do {
+        *--digitsP = '0' + (int)(value % 10);
+        value /= 10;
+    } while (value > 0);
+    if (a.getValue() < 0) *--digitsP = '-';
+    return out << digitsP;
+}
+
+/** The arbitrary precision integer type */
+typedef CheckedInteger128 BigInteger;
+
+/** The rational type */
+typedef mpq_class Rational;
+
+template <>
+struct NumberUtils<BigInteger> {
+    inline static BigInteger fromInteger64(Integer64 value) {
+        return BigInteger(value);
+    }
+    inline static BigInteger fromUnsignedInteger64(UnsignedInteger64 value) {
+        return BigInteger(value);
+    }
+    inline static bool toInteger64(const BigInteger& a, Integer64& value) {
+        if (a.getValue() < std::numeric_limits<Integer64>::min() || a.getValue() > std::numeric_limits<Integer64>::max()) {
+            return false;
+        }
+        value = (Integer64) a.getValue();
+        return true;
+    }
+    inline static int compare(const BigInteger& a, const BigInteger& b) {
+        return a < b ? -1 : (b < a ? 1 : 0);
+    }
+    // Numbers that don't fit stop the reading at the overflowing digit (the parsers can't take exceptions)
+    inline static BigInteger read(const char* string, const char** error) {
+        unsigned length = scanInteger(string);
+        *error = string + length;
+        bool negative = string[0] == '-';
+        __int128 result = 0;
+        for (unsigned i = (negative || string[0] == '+'); i < length; ++ i) {
+            int digit = negative ? '0' - string[i] : string[i] - '0';
+            if (__builtin_mul_overflow(result, 10, &result) || __builtin_add_overflow(result, digit, &result)) {
+                *error = string + i;
+                return BigInteger();
+            }
+        }
+        return BigInteger(result);
+    }
+    inline static BigInteger abs(const BigInteger& a) {
+        return a.getValue() < 0 ? -a : a;
+    }
+    inline static BigInteger gcd(const BigInteger& a, const BigInteger& b) {
+        BigInteger x = abs(a), y = abs(b), remainder;
+        while (y.getValue() != 0) {
+            x.divide(y, remainder);
+            x = y;
+            y = remainder;
+        }
+        return x;
+    }
+    inline static BigInteger lcm(const BigInteger& a, const BigInteger& b) {
+        if (a.getValue() == 0 || b.getValue() == 0) return BigInteger();
+        BigInteger remainder;
+        return abs(a).divide(gcd(a, b), remainder) * abs(b);
+    }
+    inline static BigInteger divideDown(const BigInteger& a, const BigInteger& b) {
+        BigInteger remainder;
+        BigInteger q = a.divide(b, remainder);
+        if (remainder.getValue() != 0 && ((a.getValue() < 0) != (b.getValue() < 0))) q -= BigInteger(1);
+        return q;
+    }
+    inline static BigInteger divideUp(const BigInteger& a, const BigInteger& b) {
+        BigInteger remainder;
+        BigInteger q = a.divide(b, remainder);
+        if (remainder.getValue() != 0 && ((a.getValue() < 0) == (b.getValue() < 0))) q += BigInteger(1);
+        return q;
+    }
+    inline static bool divides(const BigInteger& a, const BigInteger& b) {
+        if (a.getValue() == 0) return b.getValue() == 0;
+        BigInteger remainder;
+        b.divide(a, remainder);
+        return remainder.getValue() == 0;
+    }
+    inline static unsigned toUnsigned(const BigInteger& a) {
+        assert(0 <= a.getValue() && a.getValue() <= std::numeric_limits<unsigned>::max());
+        return (unsigned) a.getValue();
+    }
+    inline static int toInt(const BigInteger& a) {
+        assert(std::numeric_limits<int>::min() <= a.getValue() && a.getValue() <= std::numeric_limits<int>::max());
+        return (int) a.getValue();
+    }
+};
+
+#elif defined(CUTSAT_NUMBERS_GMP)
+
+/** The arbitrary precision integer type */
+typedef mpz_class BigInteger;
+
+/** The rational type */
+typedef mpq_class Rational;
+
+template <>
+struct NumberUtils<BigInteger> {
+    BOOST_STATIC_ASSERT(sizeof(long) == sizeof(Integer64));
+    inline static BigInteger fromInteger64(Integer64 value) {
+        return BigInteger((long) value);
+    }
+    inline static BigInteger fromUnsignedInteger64(UnsignedInteger64 value) {
+        return BigInteger((unsigned long) value);
+    }
+    inline static bool toInteger64(const BigInteger& a, Integer64& value) {
+        if (!mpz_fits_slong_p(a.get_mpz_t())) return false;
+        value = mpz_get_si(a.get_mpz_t());
+        return true;
+    }
+    inline static int compare(const BigInteger& a, const BigInteger& b) {
+        int result = mpz_cmp(a.get_mpz_t(), b.get_mpz_t());
+        return result < 0 ? -1 : (result > 0 ? 1 : 0);
+    }
+    inline static BigInteger read(const char* string, const char** error) {
+        unsigned length = scanInteger(string);
+        *error = string + length;
+        if (length == 0) return BigInteger();
+        // GMP doesn't take the plus sign
+        if (string[0] == '+') return BigInteger(std::string(string + 1, length - 1));
+        return BigInteger(std::string(string, length));
+    }
+    inline static BigInteger gcd(const BigInteger& a, const BigInteger& b) {
+        BigInteger result;
+        mpz_gcd(result.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        return result;
+    }
+    inline static BigInteger lcm(const BigInteger& a, const BigInteger& b) {
+        BigInteger result;
+        mpz_lcm(result.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        return result;
+    }
+    inline static BigInteger divideDown(const BigInteger& a, const BigInteger& b) {
+        BigInteger result;
+        mpz_fdiv_q(result.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        return result;
+    }
+    inline static BigInteger divideUp(const BigInteger& a, const BigInteger& b) {
+        BigInteger result;
+        mpz_cdiv_q(result.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        return result;
+    }
+    inline static bool divides(const BigInteger& a, const BigInteger& b) {
+        return mpz_divisible_p(b.get_mpz_t(), a.get_mpz_t());
+    }
+    inline static unsigned toUnsigned(const BigInteger& a) {
+        assert(mpz_fits_uint_p(a.get_mpz_t()));
+        return a.get_ui();
+    }
+    inline static int toInt(const BigInteger& a) {
+        assert(mpz_fits_sint_p(a.get_mpz_t()));
+        return a.get_si();
+    }
+};
+
+#else
+
+/** The arbitrary precision integer type */
+typedef cln::cl_I BigInteger;
+
 /** The rational type */
 typedef cln::cl_RA Rational;
 
-template <typename Number> struct NumberUtils;
+template <>
+struct NumberUtils<BigInteger> {
+    inline static BigInteger fromInteger64(Integer64 value) {
+        return BigInteger((long long) value);
+    }
+    inline static BigInteger fromUnsignedInteger64(UnsignedInteger64 value) {
+        return BigInteger((unsigned long long) value);
+    }
+    inline static bool toInteger64(const BigInteger& a, Integer64& value) {
+        if (cln::integer_length(a) >= 64) return false;
+        value = cln::cl_I_to_Q(a);
+        return true;
+    }
+    inline static int compare(const BigInteger& a, const BigInteger& b) {
+        return cln::compare(a, b);
+    }
+    inline static BigInteger read(const char* string, const char** error) {
+        return cln::read_integer(cln::cl_I_read_flags, string, NULL, error);
+    }
+    inline static BigInteger gcd(const BigInteger& a, const BigInteger& b) {
+        return cln::gcd(a, b);
+    }
+    inline static BigInteger lcm(const BigInteger& a, const BigInteger& b) {
+        return cln::lcm(a, b);
+    }
+    inline static BigInteger divideDown(const BigInteger& a, const BigInteger& b) {
+        return cln::floor1(a, b);
+    }
+    inline static BigInteger divideUp(const BigInteger& a, const BigInteger& b) {
+        return cln::ceiling1(a, b);
+    }
+    inline static bool divides(const BigInteger& a, const BigInteger& b) {
+        return cln::mod(b, a) == 0;
+    }
+    inline static unsigned toUnsigned(const BigInteger& a) {
+        return cln::cl_I_to_uint(a);
+    }
+    inline static int toInt(const BigInteger& a) {
+        return cln::cl_I_to_int(a);
+    }
+};
+
+#endif
+
+/**
+ * Pool of the heap boxes holding the backend integers of HybridInteger. Released boxes are kept
+ * constructed on a free list, so the next overflow reuses both the box and any storage the backend
+ * integer holds, instead of going to the global allocator. Conflict analysis creates and drops lots
+ * of these, and trims the pool back to a small size once it's done.
+ */
+class BigIntegerPool {
+
+    /** The free boxes */
+    std::vector<BigInteger*> d_free;
+
+    /** How many free boxes to keep after trimming */
+    static const unsigned s_retainedSize = 1024;
+
+    BigIntegerPool() {}
+
+public:
+
+    /** Trims the pool when going out of scope */
+    class Scope {
+    public:
+        ~Scope() { instance().trim(); }
+    };
+
+    /** The pool (never destroyed, so integers with static storage can still release into it) */
+    static BigIntegerPool& instance() {
+        static BigIntegerPool* s_pool = new BigIntegerPool();
+        return *s_pool;
+    }
+
+    /** Get a box holding the given value */
+    BigInteger* acquire(const BigInteger& value) {
+        if (d_free.empty()) {
+            return new BigInteger(value);
+        }
+        BigInteger* box = d_free.back();
+        d_free.pop_back();
+        *box = value;
+        return box;
+    }
+
+    /** Return the box to the pool */
+    void release(BigInteger* box) {
+        d_free.push_back(box);
+    }
+
+    /** Release the free boxes above the retained size */
+    void trim() {
+        while (d_free.size() > s_retainedSize) {
+            delete d_free.back();
+            d_free.pop_back();
+        }
+    }
+
+    /** Number of free boxes */
+    unsigned getFreeSize() const {
+        return d_free.size();
+    }
+};
+
+/**
+ * An arbitrary precision integer that keeps the value in a native word for
+ * as long as it fits, and only promotes to the backend integer when an operation
+ * overflows. Results that fit again are demoted back to the native
+ * representation. The value is tagged in the low bit (heap pointers are
+ * aligned) so the whole thing takes the same space as a pointer.
+ */
+class HybridInteger {
+
+    union {
+        /** The native value shifted left by one, with the low bit set */
+        Integer64 d_small;
+        /** The backend value, if it doesn't fit into the native one */
+        BigInteger* d_big;
+    };
+
+    /** Does the native value fit into the tagged representation */
+    static bool fits(Integer64 value) {
+        return minSmall() <= value && value <= maxSmall();
+    }
+
+    /** Set the native value, must fit */
+    void setSmall(Integer64 value) {
+        assert(fits(value));
+        d_small = (Integer64)((UnsignedInteger64)value << 1) | 1;
+    }
+
+    /** Set the value from a backend integer, demoting it to small if it fits */
+    void setBig(const BigInteger& value) {
+        Integer64 small;
+        if (NumberUtils<BigInteger>::toInteger64(value, small) && fits(small)) {
+            if (!isSmall()) BigIntegerPool::instance().release(d_big);
+            setSmall(small);
+        } else {
+            if (isSmall()) d_big = BigIntegerPool::instance().acquire(value);
+            else *d_big = value;
+        }
+    }
+
+    /** Set the value from a signed word, promoting it to big if it doesn't fit */
+    void setSigned(Integer64 value) {
+        if (fits(value)) setSmall(value);
+        else d_big = BigIntegerPool::instance().acquire(NumberUtils<BigInteger>::fromInteger64(value));
+    }
+
+    /** Set the value from an unsigned word, promoting it to big if it doesn't fit */
+    void setUnsigned(UnsignedInteger64 value) {
+        if (value <= (UnsignedInteger64) maxSmall()) setSmall(value);
+        else d_big = BigIntegerPool::instance().acquire(NumberUtils<BigInteger>::fromUnsignedInteger64(value));
+    }
+
+public:
+
+    /** Smallest value kept natively */
+    static Integer64 minSmall() {
+        return std::numeric_limits<Integer64>::min() >> 1;
+    }
+
+    /** Largest value kept natively */
+    static Integer64 maxSmall() {
+        return std::numeric_limits<Integer64>::max() >> 1;
+    }
+
+    HybridInteger()
+    { setSmall(0); }
+
+    HybridInteger(int value)
+    { setSmall(value); }
+
+    HybridInteger(unsigned value)
+    { setSmall(value); }
+
+    HybridInteger(long value)
+    { setSigned(value); }
+
+    HybridInteger(long long value)
+    { setSigned(value); }
+
+    HybridInteger(unsigned long value)
+    { setUnsigned(value); }
+
+    HybridInteger(unsigned long long value)
+    { setUnsigned(value); }
+
+    HybridInteger(const BigInteger& value)
+    { d_small = 1; setBig(value); }
+
+    HybridInteger(const HybridInteger& other) {
+        if (other.isSmall()) d_small = other.d_small;
+        else d_big = BigIntegerPool::instance().acquire(*other.d_big);
+    }
+
+    ~HybridInteger() {
+        if (!isSmall()) BigIntegerPool::instance().release(d_big);
+    }
+
+    HybridInteger& operator = (const HybridInteger& other) {
+        if (other.isSmall()) {
+            if (!isSmall()) BigIntegerPool::instance().release(d_big);
+            d_small = other.d_small;
+        } else {
+            setBig(*other.d_big);
+        }
+        return *this;
+    }
+
+    /** Is the value kept in the native representation */
+    bool isSmall() const {
+        return d_small & 1;
+    }
+
+    /** Get the native value (only if small) */
+    Integer64 getSmall() const {
+        assert(isSmall());
+        return d_small >> 1;
+    }
+
+    /** Get the value as a backend integer */
+    BigInteger getBig() const {
+        return isSmall() ? NumberUtils<BigInteger>::fromInteger64(getSmall()) : *d_big;
+    }
+
+    HybridInteger& operator += (const HybridInteger& other) {
+        if (isSmall() && other.isSmall()) {
+            // Can't overflow the native word, but might not fit the tagged one
+            setSigned(getSmall() + other.getSmall());
+        } else {
+            setBig(getBig() + other.getBig());
+        }
+        return *this;
+    }
+
+    HybridInteger& operator -= (const HybridInteger& other) {
+        if (isSmall() && other.isSmall()) {
+            // Can't overflow the native word, but might not fit the tagged one
+            setSigned(getSmall() - other.getSmall());
+        } else {
+            setBig(getBig() - other.getBig());
+        }
+        return *this;
+    }
+
+    HybridInteger& operator *= (const HybridInteger& other) {
+        Integer64 result;
+        if (isSmall() && other.isSmall() && !__builtin_mul_overflow(getSmall(), other.getSmall(), &result)) {
+            setSigned(result);
+        } else {
+            setBig(getBig() * other.getBig());
+        }
+        return *this;
+    }
+
+    HybridInteger operator - () const {
+        if (isSmall()) {
+            return HybridInteger(-getSmall());
+        } else {
+            BigInteger negated = -*d_big;
+            return HybridInteger(negated);
+        }
+    }
+
+    /** Returns -1, 0, or 1 if a < b, a = b, a > b respectively */
+    static int compare(const HybridInteger& a, const HybridInteger& b) {
+        if (a.isSmall() && b.isSmall()) {
+            // The tagging preserves the order
+            return a.d_small < b.d_small ? -1 : (a.d_small > b.d_small ? 1 : 0);
+        } else {
+            return NumberUtils<BigInteger>::compare(a.getBig(), b.getBig());
+        }
+    }
+};
+
+inline HybridInteger operator + (const HybridInteger& a, const HybridInteger& b) {
+    HybridInteger result(a);
+    return result += b;
+}
+
+inline HybridInteger operator - (const HybridInteger& a, const HybridInteger& b) {
+    HybridInteger result(a);
+    return result -= b;
+}
+
+inline HybridInteger operator * (const HybridInteger& a, const HybridInteger& b) {
+    HybridInteger result(a);
+    return result *= b;
+}
+
+inline bool operator == (const HybridInteger& a, const HybridInteger& b) {
+    return HybridInteger::compare(a, b) == 0;
+}
+
+inline bool operator != (const HybridInteger& a, const HybridInteger& b) {
+    return HybridInteger::compare(a, b) != 0;
+}
+
+inline bool operator < (const HybridInteger& a, const HybridInteger& b) {
+    return HybridInteger::compare(a, b) < 0;
+}
+
+inline bool operator <= (const HybridInteger& a, const HybridInteger& b) {
+    return HybridInteger::compare(a, b) <= 0;
+}
+
+inline bool operator > (const HybridInteger& a, const HybridInteger& b) {
+    return HybridInteger::compare(a, b) > 0;
+}
+
+inline bool operator >= (const HybridInteger& a, const HybridInteger& b) {
+    return HybridInteger::compare(a, b) >= 0;
+}
+
+inline std::ostream& operator << (std::ostream& out, const HybridInteger& a) {
+    if (a.isSmall()) {
+        out << a.getSmall();
+    } else {
+        out << a.getBig();
+    }
+    return out;
+}
+
+/** The integer type */
+typedef HybridInteger Integer;
 
 template <>
-struct NumberUtils<cln::cl_I> {
+struct NumberUtils<Integer> {
     inline static Integer read(const char* string, const char** error) {
-        return cln::read_integer(cln::cl_I_read_flags, string, NULL, error);
+        return NumberUtils<BigInteger>::read(string, error);
     }
-    inline static cln::cl_I pow(const cln::cl_I& a, unsigned pow) {
-    	return cln::expt_pos(a, pow);
+    inline static Integer pow(const Integer& a, unsigned pow) {
+        Integer result = 1, square = a;
+        for (; pow > 0; pow >>= 1) {
+            if (pow & 1) result *= square;
+            if (pow > 1) square *= square;
+        }
+        return result;
     }
-    inline static cln::cl_I ceil(double value) {
+    inline static Integer ceil(double value) {
         return boost::numeric::Ceil<int>::nearbyint(value);
     }
-    inline static cln::cl_I floor(double value) {
+    inline static Integer floor(double value) {
         return boost::numeric::Floor<int>::nearbyint(value);
     }
-    inline static cln::cl_I lcm(const cln::cl_I& a, const cln::cl_I& b) {
-        return cln::lcm(a, b);
+    inline static Integer lcm(const Integer& a, const Integer& b) {
+        if (a.isSmall() && b.isSmall()) {
+            Integer64 aAbs = std::abs(a.getSmall());
+            Integer64 bAbs = std::abs(b.getSmall());
+            if (aAbs == 0 || bAbs == 0) return 0;
+            Integer64 result;
+            if (!__builtin_mul_overflow(aAbs / boost::math::gcd(aAbs, bAbs), bAbs, &result)) {
+                return result;
+            }
+        }
+        return NumberUtils<BigInteger>::lcm(a.getBig(), b.getBig());
     }
-    inline static cln::cl_I gcd(const cln::cl_I& a, const cln::cl_I& b) {
-        return cln::gcd(a, b);
+    inline static Integer gcd(const Integer& a, const Integer& b) {
+        if (a.isSmall() && b.isSmall()) {
+            return boost::math::gcd(a.getSmall(), b.getSmall());
+        }
+        return NumberUtils<BigInteger>::gcd(a.getBig(), b.getBig());
     }
-    inline static cln::cl_I abs(const cln::cl_I& a) {
-        return cln::abs(a);
+    inline static Integer abs(const Integer& a) {
+        return a < 0 ? -a : a;
     }
-    inline static unsigned toUnsigned(const cln::cl_I& x) {
-        return cln::cl_I_to_uint(x);
+    inline static unsigned toUnsigned(const Integer& x) {
+        if (x.isSmall() && x.getSmall() >= 0 && x.getSmall() <= std::numeric_limits<unsigned>::max()) {
+            return x.getSmall();
+        }
+        return NumberUtils<BigInteger>::toUnsigned(x.getBig());
     }
-    inline static int toInt(const cln::cl_I& x) {
-        return cln::cl_I_to_int(x);
+    inline static int toInt(const Integer& x) {
+        if (x.isSmall() && x.getSmall() >= std::numeric_limits<int>::min() && x.getSmall() <= std::numeric_limits<int>::max()) {
+            return x.getSmall();
+        }
+        return NumberUtils<BigInteger>::toInt(x.getBig());
     }
-    inline static cln::cl_I divideDown(const cln::cl_I& a, const cln::cl_I& b) {
-        return cln::floor1(a, b);
+    inline static Integer divideDown(const Integer& a, const Integer& b) {
+        if (a.isSmall() && b.isSmall()) {
+            Integer64 q = a.getSmall() / b.getSmall();
+            if (a.getSmall() % b.getSmall() != 0 && ((a.getSmall() < 0) != (b.getSmall() < 0))) -- q;
+            return q;
+        }
+        return NumberUtils<BigInteger>::divideDown(a.getBig(), b.getBig());
     }
-    inline static cln::cl_I divideUp(const cln::cl_I& a, const cln::cl_I& b) {
-        return cln::ceiling1(a, b);
+    inline static Integer divideUp(const Integer& a, const Integer& b) {
+        if (a.isSmall() && b.isSmall()) {
+            Integer64 q = a.getSmall() / b.getSmall();
+            if (a.getSmall() % b.getSmall() != 0 && ((a.getSmall() < 0) == (b.getSmall() < 0))) ++ q;
+            return q;
+        }
+        return NumberUtils<BigInteger>::divideUp(a.getBig(), b.getBig());
     }
     // Does a divide b
-    inline static bool divides(const cln::cl_I& a, const cln::cl_I& b) {
-    	return cln::mod(b, a) == 0;
+    inline static bool divides(const Integer& a, const Integer& b) {
+        if (a.isSmall() && b.isSmall() && a.getSmall() != 0) {
+            return b.getSmall() % a.getSmall() == 0;
+        }
+    	return NumberUtils<BigInteger>::divides(a.getBig(), b.getBig());
     }
     // Return number of digits of a
-    inline static unsigned digits(cln::cl_I a) {
+    inline static unsigned digits(Integer a) {
     	unsigned digits = 0;
     	do {
     		digits ++;
-    		a = cln::floor1(a, 10);
+    		a = divideDown(a, 10);
     	} while (a > 0);
     	return digits;
     }
 };
 
+#if defined(CUTSAT_NUMBERS_GMP) || defined(CUTSAT_NUMBERS_INT128)
+
 template <>
-struct NumberUtils<cln::cl_RA> {
-    inline static cln::cl_RA read(const char* string, const char** error) {
+struct NumberUtils<Rational> {
+    inline static Rational read(const char* string, const char** error) {
+        unsigned length = scanInteger(string);
+        if (length > 0 && string[length] == '/') {
+            unsigned denominatorLength = scanInteger(string + length + 1);
+            if (denominatorLength > 0) length += denominatorLength + 1;
+        }
+        *error = string + length;
+        if (length == 0) return Rational();
+        // GMP doesn't take the plus sign
+        Rational result(string[0] == '+' ? std::string(string + 1, length - 1) : std::string(string, length));
+        result.canonicalize();
+        return result;
+    }
+    inline static Rational ceil(double value) {
+        return Rational(value);
+    }
+    inline static Rational floor(double value) {
+        return Rational(value);
+    }
+    inline static Integer getDenominator(const Rational& value) {
+        return toInteger(value.get_den());
+    }
+    inline static Integer getNumerator(const Rational& value) {
+        return toInteger(value.get_num());
+    }
+    inline static Integer ceil(const Rational& value) {
+        return NumberUtils<Integer>::divideUp(getNumerator(value), getDenominator(value));
+    }
+    inline static Integer floor(const Rational& value) {
+        return NumberUtils<Integer>::divideDown(getNumerator(value), getDenominator(value));
+    }
+private:
+    inline static Integer toInteger(const mpz_class& value) {
+#if defined(CUTSAT_NUMBERS_GMP)
+        return value;
+#else
+        if (mpz_fits_slong_p(value.get_mpz_t())) {
+            return value.get_si();
+        }
+        const char* error;
+        std::string digits = value.get_str();
+        BigInteger result = NumberUtils<BigInteger>::read(digits.c_str(), &error);
+        if (*error != 0) BigInteger::overflow();
+        return result;
+#endif
+    }
+};
+
+#else
+
+template <>
+struct NumberUtils<Rational> {
+    inline static Rational read(const char* string, const char** error) {
         return cln::read_rational(cln::cl_RA_read_flags, string, NULL, error);
     }
-    inline static cln::cl_RA ceil(double value) {
+    inline static Rational ceil(double value) {
         return cln::rational(cln::cl_DF(value));
     }
-    inline static cln::cl_RA floor(double value) {
+    inline static Rational floor(double value) {
         return cln::rational(cln::cl_DF(value));
     }
-    inline static cln::cl_I getDenominator(const cln::cl_RA& value) {
+    inline static Integer getDenominator(const Rational& value) {
         return cln::denominator(value);
     }
-    inline static cln::cl_I getNumerator(const cln::cl_RA& value) {
+    inline static Integer getNumerator(const Rational& value) {
         return cln::numerator(value);
     }
-    inline static cln::cl_I ceil(const cln::cl_RA& value) {
+    inline static Integer ceil(const Rational& value) {
         return NumberUtils<Integer>::divideUp(getNumerator(value), getDenominator(value));
     }
-    inline static cln::cl_I floor(const cln::cl_RA& value) {
+    inline static Integer floor(const Rational& value) {
         return NumberUtils<Integer>::divideDown(getNumerator(value), getDenominator(value));
     }
 };
 
+#endif
+
 template <>
 struct NumberUtils<int> {
     inline static int read(const char* string, const char** error) {
@@ -192,6 +192,8 @@ void getOptions(int argc, char* argv[], variables_map& variables) {
         		"Validate the model if the problem is satisfiable")
         ("default-bound", value<int>()->default_value(-1),
         		"Default value for unbounded variables")
+        ("chronological-backtracking", value<unsigned>()->default_value(0),
+        		"Backtrack only one level on conflicts that would jump back more than the given number of levels (0 to disable)")
     ;
 
     // The input files can be positional
@@ -263,4 +265,5 @@ void setOptions(Solver& solver, variables_map& options) {
   solver.setDefaultBound(options.at("default-bound").as<int>());
   solver.setReplaceVarsWithSlacks(options.count("replace-vars-with-slacks") > 0);
   solver.setTryFourierMotzkin(options.count("try-fourier-motzkin") > 0);
+  solver.setChronologicalBacktrackLevels(options.at("chronological-backtracking").as<unsigned>());
 }
@@ -123,7 +123,7 @@ void MpsParser::addConstraint(BoundType type, std::vector<Variable>& vars, std::
 
     bool hasRational = false; // Does the constraint have rational variables
 
-    Integer denominatorLCM = cln::abs(cDenominator); // Least common multiple of the denominators
+    Integer denominatorLCM = NumberUtils<Integer>::abs(cDenominator); // Least common multiple of the denominators
 
     // Compute the LCM of the coefficients
     unsigned nLiterals = vars.size();
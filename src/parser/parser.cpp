@@ -19,6 +19,7 @@
 
 #include <cstring>
 #include <sstream>
+#include <limits>
 #include "parser/parser.h"
 #include "parser/ilp_parser.h"
 #include "parser/mps_parser.h"
@@ -88,6 +89,15 @@ void Parser::addCardinalityConstraint(const std::vector<Integer>& coefficients,
 }
 
 void Parser::addIntegerConstraint(const std::vector<Integer>& coefficients, const std::vector<Variable>& variables, Integer& rhs) {
+    // Boolean rows go to the pseudo-Boolean constraints
+    std::map<Variable, Integer> merged;
+    for (unsigned i = 0; i < variables.size(); ++ i) {
+        merged[variables[i]] += coefficients[i];
+    }
+    if (addPseudoBooleanConstraint(merged, rhs)) {
+        return;
+    }
+
     std::vector<IntegerConstraintLiteral> literals;
     for (unsigned i = 0; i < variables.size(); ++ i) {
         literals.push_back(IntegerConstraintLiteral(coefficients[i], variables[i]));
@@ -151,5 +161,41 @@ void Parser::addIntegerConstraint(const std::map<Variable, Integer>& coefficient
         }
     }
 
+    // Other Boolean rows go to the pseudo-Boolean constraints
+    if (isBoolean && addPseudoBooleanConstraint(coefficients, rhs)) {
+        return;
+    }
+
     d_solver.assertIntegerConstraint(literals, rhs);
 }
+
+bool Parser::addPseudoBooleanConstraint(const std::map<Variable, Integer>& coefficients, const Integer& rhs) {
+    std::vector<PseudoBooleanConstraintLiteral> literals;
+    std::map<Variable, Integer>::const_iterator it = coefficients.begin();
+    std::map<Variable, Integer>::const_iterator it_end = coefficients.end();
+
+    // The weights must fit into 32 bits and their sum (with the constant) into a native integer
+    Integer total = NumberUtils<Integer>::abs(rhs);
+    Integer maxWeight = std::numeric_limits<boost::int32_t>::max();
+    for (; it != it_end; ++ it) {
+        if (it->second == 0) {
+            continue;
+        }
+        if (!d_solver.isBoolean(it->first)) {
+            return false;
+        }
+        Integer weight = NumberUtils<Integer>::abs(it->second);
+        if (weight > maxWeight) {
+            return false;
+        }
+        total += weight;
+        literals.push_back(PseudoBooleanConstraintLiteral((boost::int32_t) it->second.getSmall(), it->first));
+    }
+    if (!total.isSmall()) {
+        return false;
+    }
+
+    Integer64 c = rhs.getSmall();
+    d_solver.assertPseudoBooleanConstraint(literals, c);
+    return true;
+}
@@ -121,6 +121,13 @@ public:
      */
     void addIntegerConstraint(const std::map<Variable, Integer>& coefficients, Integer& rhs);
 
+    /**
+     * Adds a parsed integer constraint to the solver as a pseudo-Boolean constraint, if all the variables
+     * are Boolean and the coefficients are small enough.
+     * @return true if the constraint was added
+     */
+    bool addPseudoBooleanConstraint(const std::map<Variable, Integer>& coefficients, const Integer& rhs);
+
 };
 
 
@@ -30,6 +30,11 @@ void CardinalityConstraintPropagator::repropagate(ConstraintRef constraintRef) {
 
     CUTSAT_TRACE("propagator::cardinality") << d_propagationVariable << "," <<  constraint << std::endl;
 
+    if (constraint.getAdditionalData().counting) {
+    	propagateCounter(constraintRef, constraint);
+    	return;
+    }
+
     unsigned c = constraint.getConstant();
     for (unsigned i = c, i_end = constraint.getSize(); i < i_end; ++ i) {
         const CardinalityConstraintLiteral& literal = constraint.getLiteral(i);
@@ -66,6 +71,12 @@ bool CardinalityConstraintPropagator::propagate(Variable var, ConstraintRef cons
 
     CUTSAT_TRACE("propagator::cardinality") << var << "," <<  constraint << std::endl;
 
+    // Counting constraints watch all the literals, and never move the watches
+    if (constraint.getAdditionalData().counting) {
+    	propagateCounter(constraintRef, constraint);
+    	return false;
+    }
+
     // The number of literals we are watching
     unsigned c = constraint.getConstant();
 
@@ -167,6 +178,21 @@ void CardinalityConstraintPropagator::attachConstraint(ConstraintRef constraintR
     CardinalityConstraint& constraint = d_constraintManager.get<ConstraintTypeCardinality>(constraintRef);
     CUTSAT_TRACE("propagator::cardinality") << "attaching: " << constraint << std::endl;
 
+    // With a big constant, count the false literals and watch all of them
+    if (useCounter(constraint.getSize(), constraint.getConstant())) {
+    	d_solverState.attachCounter(constraintRef);
+    	for (unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+    		const CardinalityConstraintLiteral& lit = constraint.getLiteral(i);
+    		if (lit.isNegated()) {
+    			d_watchManager.getWatchList(lit.getVariable(), MODIFICATION_LOWER_BOUND_REFINE).push_back<false>(constraintRef);
+    		} else {
+    			d_watchManager.getWatchList(lit.getVariable(), MODIFICATION_UPPER_BOUND_REFINE).push_back<true>(constraintRef);
+    		}
+    	}
+    	propagateCounter(constraintRef, constraint);
+    	return;
+    }
+
     // Sort the literals in order to attach
     cardinality_sort sorter(d_solverState);
     constraint.sort(sorter);
@@ -207,6 +233,59 @@ void CardinalityConstraintPropagator::attachConstraint(ConstraintRef constraintR
     }
 }
 
+void CardinalityConstraintPropagator::propagateCounter(ConstraintRef constraintRef, const CardinalityConstraint& constraint) {
+
+    unsigned size = constraint.getSize();
+    unsigned c = constraint.getConstant();
+    unsigned falseLiterals = constraint.getAdditionalData().falseLiterals;
+
+    // Enough literals can still be true
+    if (falseLiterals + c < size) {
+    	return;
+    }
+
+    CUTSAT_TRACE("propagator::cardinality") << "counter propagates: " << constraint << std::endl;
+
+    // Too many false literals, conflict on the last one to become false
+    if (falseLiterals + c > size) {
+    	int conflictIndex = -1;
+    	int conflictTrailIndex = -1;
+    	for (unsigned i = 0; i < size; ++ i) {
+    		const CardinalityConstraintLiteral& literal = constraint.getLiteral(i);
+    		if (d_solverState.isAssigned(literal.getVariable()) && d_solverState.getCurrentValue(literal) == 0) {
+    			int trailIndex = d_solverState.getLastModificationTrailIndex<true>(literal.getVariable());
+    			if (trailIndex > conflictTrailIndex) {
+    				conflictIndex = i;
+    				conflictTrailIndex = trailIndex;
+    			}
+    		}
+    	}
+    	assert(conflictIndex >= 0);
+    	const CardinalityConstraintLiteral& literal = constraint.getLiteral(conflictIndex);
+    	if (literal.isNegated()) {
+    		d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(literal.getVariable(), 0, constraintRef);
+    	} else {
+    		d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(literal.getVariable(), 1, constraintRef);
+    	}
+    	return;
+    }
+
+    // Exactly the needed literals are not false, so they must all be true
+    for (unsigned i = 0; i < size && !d_solverState.inConflict(); ++ i) {
+    	const CardinalityConstraintLiteral& propagationLiteral = constraint.getLiteral(i);
+    	Variable propagationVariable = propagationLiteral.getVariable();
+    	if (propagationLiteral.isNegated()) {
+    		if (d_solverState.getUpperBound<TypeInteger>(propagationVariable) == 1 && d_solverState.getLowerBound<TypeInteger>(propagationVariable) == 0) {
+    			d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(propagationVariable, 0, constraintRef);
+    		}
+    	} else {
+    		if (d_solverState.getLowerBound<TypeInteger>(propagationVariable) == 0 && d_solverState.getUpperBound<TypeInteger>(propagationVariable) == 1) {
+    			d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(propagationVariable, 1, constraintRef);
+    		}
+    	}
+    }
+}
+
 PreprocessStatus CardinalityConstraintPropagator::preprocess(
 		std::vector<CardinalityConstraintLiteral>& literals, constant_type& constant, int zeroLevelIndex) {
 
@@ -38,6 +38,23 @@ public:
 	void attachConstraint(ConstraintRef constraintRef);
 	PreprocessStatus preprocess(std::vector<literal_type>& literals, constant_type& constant, int zeroLevelIndex);
 	void removeConstraint(ConstraintRef constraintRef);
+
+private:
+
+	/**
+	 * Returns true if the constraint should be propagated by counting its false literals instead of watching them.
+	 * With a constant of at least half the size most of the literals would be watched anyway, and the watches would
+	 * rarely find a replacement.
+	 */
+	static bool useCounter(unsigned size, unsigned constant) {
+		return 2 * constant >= size;
+	}
+
+	/**
+	 * Propagates the counting constraint: if only the needed number of literals is not false, they must all be
+	 * true, and if less than that, one of the false literals is propagated into a conflict.
+	 */
+	void propagateCounter(ConstraintRef constraintRef, const CardinalityConstraint& constraint);
 };
 
 }
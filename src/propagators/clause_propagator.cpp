@@ -42,6 +42,11 @@ void ClauseConstraintPropagator::removeConstraint(ConstraintRef constraintRef) {
 }
 
 void ClauseConstraintPropagator::repropagate(ConstraintRef constraintRef) {
+    if (ConstraintManager::isBinaryClause(constraintRef)) {
+    	repropagateBinaryClause(constraintRef);
+    	return;
+    }
+
     // Get the constraint
     ClauseConstraint& clause = d_constraintManager.get<ConstraintTypeClause>(constraintRef);
     CUTSAT_TRACE_FN("propagator::clause") << d_propagationVariable << " with " << clause << std::endl;
@@ -62,22 +67,104 @@ void ClauseConstraintPropagator::repropagate(ConstraintRef constraintRef) {
     }
 
    	// Propagate
-    if (l0.isNegated()) {
+    propagateLiteral(l0, constraintRef);
+}
+
+void ClauseConstraintPropagator::repropagateBinaryClause(ConstraintRef constraintRef) {
+    const BinaryClause& clause = d_constraintManager.getBinaryClause(constraintRef);
+    CUTSAT_TRACE_FN("propagator::clause") << d_propagationVariable << " with " << clause << std::endl;
+
+    // The propagated literal and the other one
+    ClauseConstraintLiteral l0 = clause.getLiteral(0);
+    ClauseConstraintLiteral l1 = clause.getLiteral(1);
+    if (l1.getVariable() == d_propagationVariable) {
+    	std::swap(l0, l1);
+    }
+    if (d_propagationVariable != l0.getVariable() || d_solverState.isAssigned(d_propagationVariable)) {
+    	return;
+    }
+
+    // Propagate if the other one is false
+    if (d_solverState.isAssigned(l1.getVariable()) && !isTrue(l1)) {
+    	propagateLiteral(l0, constraintRef);
+    }
+}
+
+void ClauseConstraintPropagator::propagateLiteral(ClauseConstraintLiteral literal, ConstraintRef constraintRef) {
+    if (literal.isNegated()) {
     	// Propagate upper bound, i.e. var <= 0
-        d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(d_propagationVariable, 0, constraintRef);
+        d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(literal.getVariable(), 0, constraintRef);
     } else {
     	// Propagate lower bound, i.e. var >= 1
-        d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(d_propagationVariable, 1, constraintRef);
+        d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(literal.getVariable(), 1, constraintRef);
     }
 }
 
 
+void ClauseConstraintPropagator::watch(ClauseConstraintLiteral literal, ConstraintRef constraintRef, ClauseConstraintLiteral blocker) {
+    if (literal.isNegated()) {
+        // We want to know when the literal becomes false, i.e the variable becomes true, so we watch the lower bound
+        d_watchManager.getWatchList(literal.getVariable(), MODIFICATION_LOWER_BOUND_REFINE).push_back(blocked_watch(constraintRef, blocker));
+    } else {
+        // We want to know when the literal becomes false, i.e the variable becomes false, so we watch the upper bound
+        d_watchManager.getWatchList(literal.getVariable(), MODIFICATION_UPPER_BOUND_REFINE).push_back(blocked_watch(constraintRef, blocker));
+    }
+}
+
+void ClauseConstraintPropagator::propagateEvent(Variable triggerVar, VariableModificationType eventType) {
+
+    // Get the watch list according to the event
+    BasicWatchList<blocked_watch>& watchList = d_watchManager.getWatchList(triggerVar, eventType);
+
+    // Go through the watches, the ones with a true blocker are kept without looking at the clause
+    BasicWatchList<blocked_watch>::iterator watch_i = watchList.begin();
+    BasicWatchList<blocked_watch>::iterator watch_j = watchList.begin();
+    BasicWatchList<blocked_watch>::iterator watch_i_end = watchList.end();
+    while (watch_i != watch_i_end) {
+
+        // If the blocker is true, the clause is satisfied
+        if (isTrue(watch_i->blocker)) {
+            *watch_j++ = *watch_i++;
+            continue;
+        }
+
+        // Binary clauses are just the implication of the blocker, and keep the watch
+        bool removeWatch = false;
+        if (ConstraintManager::isBinaryClause(watch_i->constraint)) {
+            propagateLiteral(watch_i->blocker, watch_i->constraint);
+        } else {
+            // Should we remove this watch
+            removeWatch = propagate(triggerVar, *watch_i);
+        }
+
+        // If we keep this watch go on
+        if (!removeWatch) {
+            *watch_j++ = *watch_i++;
+        } else {
+            watch_i ++;
+        }
+
+        // If in conflict
+        if (d_solverState.inConflict()) {
+            // Copy the remaining watches
+            while (watch_i != watch_i_end) {
+                *watch_j++ = *watch_i++;
+            }
+            break;
+        }
+    }
+
+    // Shrink the watch-list
+    watchList.resize(watch_j);
+}
+
 // Clause propagator doesn't care which bound got propagated, it should be on the right watch-list
-bool ClauseConstraintPropagator::propagate(Variable var, ConstraintRef constraintRef, VariableModificationType eventType) {
+bool ClauseConstraintPropagator::propagate(Variable var, blocked_watch& watch) {
 
     // Get the constraint
+    ConstraintRef constraintRef = watch.constraint;
     ClauseConstraint& clause = d_constraintManager.get<ConstraintTypeClause>(constraintRef);
-    CUTSAT_TRACE_FN("propagator::clause") << var << "[" << eventType << "]" << "," << clause << std::endl;
+    CUTSAT_TRACE_FN("propagator::clause") << var << "," << clause << std::endl;
 
     // Get the literals (REFERENCES! hence always first and second
     ClauseConstraintLiteral& firstLiteral = clause.getLiteral(0);
@@ -90,11 +177,12 @@ bool ClauseConstraintPropagator::propagate(Variable var, ConstraintRef constrain
         assert(secondLiteral.getVariable() == var);
     }
 
-    CUTSAT_TRACE("propagator::clause") << var << "[" << eventType << "]" << "," << clause << std::endl;
+    CUTSAT_TRACE("propagator::clause") << var << "," << clause << std::endl;
 
     // If a clause and 0th watch is true, then clause is already satisfied.
-    if (d_solverState.isAssigned(firstLiteral.getVariable()) && d_solverState.getCurrentValue<ConstraintTypeClause>(firstLiteral) == 1) {
+    if (isTrue(firstLiteral)) {
         CUTSAT_TRACE("propagator::clause") << "First literal already assigned to true!" << std::endl;
+        watch.blocker = firstLiteral;
         return false;
     }
 
@@ -109,33 +197,23 @@ bool ClauseConstraintPropagator::propagate(Variable var, ConstraintRef constrain
         } else if (d_solverState.getCurrentValue<ConstraintTypeClause>(literal) == 1) {
             // This is a clause and we are already satisfied
             CUTSAT_TRACE("propagator::clause") << "Clause already satisfied!" << std::endl;
+            watch.blocker = literal;
             return false;
         }
     }
 
     // If no watch has been found
     if (newWatch == 0) {
-        Variable propagationVariable = firstLiteral.getVariable();
-        if (firstLiteral.isNegated()) {
-            // Propagate upper bound, i.e. var <= 0
-            d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(propagationVariable , 0, constraintRef);
-        } else {
-            // Propagate lower bound, i.e. var >= 1
-            d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(propagationVariable , 1, constraintRef);
-        }
+        propagateLiteral(firstLiteral, constraintRef);
     }
     // We found a new watch
     else {
         CUTSAT_TRACE("propagator::clause") << "Found a new watch at position " << newWatch << std::endl;
         // Put the new watch on the spot
         clause.swapLiterals(1, newWatch);
-        // Add the watch to the watch list
+        // Add the watch to the watch list, blocked by the other watched literal
         CUTSAT_TRACE("propagator::clause") << "attaching to literal " << secondLiteral << " for clause " << clause << std::endl;
-        if (secondLiteral.isNegated()) {
-            d_watchManager.getWatchList(secondLiteral.getVariable(), MODIFICATION_LOWER_BOUND_REFINE).push_back<false>(constraintRef);
-        } else {
-            d_watchManager.getWatchList(secondLiteral.getVariable(), MODIFICATION_UPPER_BOUND_REFINE).push_back<true>(constraintRef);
-        }
+        this->watch(secondLiteral, constraintRef, firstLiteral);
         // Since we checnged the watch we can erase this one
         return true;
     }
@@ -147,6 +225,11 @@ bool ClauseConstraintPropagator::propagate(Variable var, ConstraintRef constrain
 void ClauseConstraintPropagator::attachConstraint(ConstraintRef constraintRef) {
     CUTSAT_TRACE_FN("propagator::clause");
 
+    if (ConstraintManager::isBinaryClause(constraintRef)) {
+    	attachBinaryClause(constraintRef);
+    	return;
+    }
+
     // Get the constraint
     ClauseConstraint& clause = d_constraintManager.get<ConstraintTypeClause>(constraintRef);
     CUTSAT_TRACE("propagator::clause") << "attaching: " << clause << std::endl;
@@ -159,30 +242,15 @@ void ClauseConstraintPropagator::attachConstraint(ConstraintRef constraintRef) {
     	}
     }
 
-    // Attach the first literal
-    ClauseConstraintLiteral& l0 = clause.getLiteral(0);
-    if (l0.isNegated()) {
-        // We want to know when l0 becomes false, i.e the variable becomes true, so we watch the lower bound
-        d_watchManager.getWatchList(l0.getVariable(), MODIFICATION_LOWER_BOUND_REFINE).push_back<false>(constraintRef);
-    } else {
-        // We want to know when l0 becomes false, i.e the variable becomes false, so we watch the upper bound
-        d_watchManager.getWatchList(l0.getVariable(), MODIFICATION_UPPER_BOUND_REFINE).push_back<true>(constraintRef);
-    }
-
     // If there is only one unassigned literal, we propagate it
     assert(j > 0);
+    ClauseConstraintLiteral& l0 = clause.getLiteral(0);
     ClauseConstraintLiteral& l1 = clause.getLiteral(1);
     if (j == 1) {
         CUTSAT_TRACE("propagator::clause") << "propagates at attachment: " << clause << std::endl;
         assert(l0.getVariable() == d_propagationVariable);
     	// Propagate
-    	if (l0.isNegated()) {
-    		// Propagate upper bound, i.e. var <= 0
-    	    d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(l0.getVariable(), 0, constraintRef);
-    	} else {
-    		// Propagate lower bound, i.e. var >= 1
-    	    d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(l0.getVariable(), 1, constraintRef);
-    	}
+    	propagateLiteral(l0, constraintRef);
     	// Now, put the second highest literal to the second place
     	for (unsigned i = 2; i < clause.getSize(); ++ i) {
     		const ClauseConstraintLiteral& current = clause.getLiteral(i);
@@ -192,14 +260,33 @@ void ClauseConstraintPropagator::attachConstraint(ConstraintRef constraintRef) {
     	}
     }
 
-    // Attach the second literal
-    if (l1.isNegated()) {
-        // We want to know when l1 becomes false, i.e the variable becomes true, so we watch the lower bound
-        d_watchManager.getWatchList(l1.getVariable(), MODIFICATION_LOWER_BOUND_REFINE).push_back<false>(constraintRef);
-    } else {
-        // We want to know when l1 becomes false, i.e the variable becomes false, so we watch the upper bound
-        d_watchManager.getWatchList(l1.getVariable(), MODIFICATION_UPPER_BOUND_REFINE).push_back<true>(constraintRef);
+    // Attach the two literals, each one blocked by the other
+    watch(l0, constraintRef, l1);
+    watch(l1, constraintRef, l0);
+}
+
+void ClauseConstraintPropagator::attachBinaryClause(ConstraintRef constraintRef) {
+
+    const BinaryClause& clause = d_constraintManager.getBinaryClause(constraintRef);
+    CUTSAT_TRACE("propagator::clause") << "attaching: " << clause << std::endl;
+
+    // Put the unassigned literal first
+    ClauseConstraintLiteral l0 = clause.getLiteral(0);
+    ClauseConstraintLiteral l1 = clause.getLiteral(1);
+    if (d_solverState.isAssigned(l0.getVariable())) {
+    	std::swap(l0, l1);
     }
+
+    // If only one is unassigned and the other one is false, we propagate it
+    assert(!d_solverState.isAssigned(l0.getVariable()));
+    if (d_solverState.isAssigned(l1.getVariable()) && !isTrue(l1)) {
+        CUTSAT_TRACE("propagator::clause") << "propagates at attachment: " << clause << std::endl;
+    	propagateLiteral(l0, constraintRef);
+    }
+
+    // Each literal implies the other one
+    watch(l0, constraintRef, l1);
+    watch(l1, constraintRef, l0);
 }
 
 PreprocessStatus ClauseConstraintPropagator::preprocess(std::vector<literal_type>& literals, constant_type& c, int zeroLevelIndex) {
@@ -26,15 +26,34 @@
 namespace cutsat {
 
 /**
- * Specialization of the propagator for clause constraints
+ * Specialization of the propagator for clause constraints. The watches carry the other watched literal
+ * as the blocker, so that the satisfied clauses are skipped without being looked at. Binary problem clauses
+ * have no constraint in memory, their watches are just the implications of the blocker.
  */
-class ClauseConstraintPropagator : public Propagator<ConstraintTypeClause> {
+class ClauseConstraintPropagator : public Propagator<ConstraintTypeClause, blocked_watch> {
+
+	/** Returns true if the literal is assigned to true */
+	bool isTrue(ClauseConstraintLiteral literal) const {
+		return d_solverState.isAssigned(literal.getVariable()) && d_solverState.getCurrentValue<ConstraintTypeClause>(literal) == 1;
+	}
+
+	/** Adds the watch on the literal of the clause, with the given blocker */
+	void watch(ClauseConstraintLiteral literal, ConstraintRef constraintRef, ClauseConstraintLiteral blocker);
+
+	/** Propagates the literal to true, with the given clause as the reason */
+	void propagateLiteral(ClauseConstraintLiteral literal, ConstraintRef constraintRef);
+
+	/** Repropagation and attachment of the binary clauses */
+	void repropagateBinaryClause(ConstraintRef constraintRef);
+	void attachBinaryClause(ConstraintRef constraintRef);
+
 public:
 	ClauseConstraintPropagator(ConstraintManager& constraintManager, SolverState& solverState)
-	: Propagator<ConstraintTypeClause>(constraintManager, solverState) { }
+	: Propagator<ConstraintTypeClause, blocked_watch>(constraintManager, solverState) { }
 
+	void propagateEvent(Variable triggerVar, VariableModificationType eventType);
 	void repropagate(ConstraintRef constraintRef);
-	bool propagate(Variable var, ConstraintRef constraintRef, VariableModificationType eventType);
+	bool propagate(Variable var, blocked_watch& watch);
 	void attachConstraint(ConstraintRef constraintRef);
 	PreprocessStatus preprocess(std::vector<literal_type>& literals, constant_type& constant, int zeroLevelIndex);
 	void removeConstraint(ConstraintRef constraintRef);
@@ -23,7 +23,10 @@ using namespace cutsat;
 
 TraceTag integerPropagator("propagator::integer");
 
-PreprocessStatus IntegerConstraintPropagator::preprocess(std::vector<IntegerConstraintLiteral>& literals, Integer& constant, int zeroLevelIndex) {
+namespace cutsat {
+
+template<>
+PreprocessStatus IntegerConstraintPropagator<ConstraintTypeInteger>::preprocess(std::vector<IntegerConstraintLiteral>& literals, Integer& constant, int zeroLevelIndex) {
 
     CUTSAT_TRACE_FN("propagator::integer") << "preprocessing: " << literals << " >= " << constant << std::endl;
 
@@ -73,115 +76,107 @@ PreprocessStatus IntegerConstraintPropagator::preprocess(std::vector<IntegerCons
 	return PREPROCESS_OK;
 }
 
-void IntegerConstraintPropagator::attachConstraint(ConstraintRef constraintRef) {
+template<>
+PreprocessStatus IntegerConstraintPropagator<ConstraintTypeInteger64>::preprocess(std::vector<Integer64ConstraintLiteral>& literals, Integer64& constant, int zeroLevelIndex) {
+    // Unreachable: the solver always preprocesses as ConstraintTypeInteger, and only then newConstraint() picks
+    // the native type if the preprocessed coefficients and constant fit
+    assert(false);
+    return PREPROCESS_OK;
+}
+
+}
+
+template<ConstraintType type>
+void IntegerConstraintPropagator<type>::attachConstraint(ConstraintRef constraintRef) {
 
     // Get the constraint
-    IntegerConstraint& constraint = d_constraintManager.get<ConstraintTypeInteger>(constraintRef);
+    constraint_type& constraint = d_constraintManager.template get<type>(constraintRef);
     CUTSAT_TRACE_FN("propagator::integer") << constraint << std::endl;
 
+    // Keep track of the maximal value of the constraint
+    d_solverState.template attachActivity<type>(constraintRef);
+
     // Attach to all the variables in the constraint and see if one can propagae something
+    const literal_storage literals = constraint.getLiterals();
     for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
     	// Get the variable
-    	const IntegerConstraintLiteral& literal = constraint.getLiteral(i);
-    	Variable var = literal.getVariable();
+    	Variable var = literals.getVariable(i);
     	// Attach to the watchlists
-    	if (literal.getCoefficient() > 0) {
+    	if (literals.getCoefficient(i) > 0) {
             // Attach to the any modification watch list
-            d_watchManager.getWatchList(var, MODIFICATION_ANY).push_back<true>(constraintRef);
+            d_watchManager.getWatchList(var, MODIFICATION_ANY).template push_back<true>(constraintRef);
     	} else {
             // Attach to the any modification watch list
-            d_watchManager.getWatchList(var, MODIFICATION_ANY).push_back<false>(constraintRef);
+            d_watchManager.getWatchList(var, MODIFICATION_ANY).template push_back<false>(constraintRef);
     	}
     }
 
+    if (!constraint.isLearnt()) {
+        // Propagate with the bounds we already have
+        propagateConstraint(constraintRef);
+    }
+
     if (constraint.isLearnt()) {
     	// Propagate something
-    	Integer sum = 0;
-    	Integer propagatingVarCoefficient;
-    	for (unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
-    		const IntegerConstraintLiteral& literal = constraint.getLiteral(i);
-        	Variable var = literal.getVariable();
-        	if (var == d_propagationVariable) {
-        		propagatingVarCoefficient = literal.getCoefficient();
-        		continue;
-        	}
-        	if (literal.getCoefficient() > 0) {
-        		sum += d_solverState.getUpperBound<TypeInteger>(var) * literal.getCoefficient();
-        	} else {
-        		sum += d_solverState.getLowerBound<TypeInteger>(var) * literal.getCoefficient();
-        	}
-
-    	}
+    	Integer max;
+    	const coefficient_type& propagatingVarCoefficient = getCoefficient(constraint, d_propagationVariable);
+    	bool bounded = getMaxWithout(constraint, d_propagationVariable, propagatingVarCoefficient, max);
+    	assert(bounded);
+    	(void)bounded;
     	// We must be able to propagate something
     	if (propagatingVarCoefficient > 0) {
-        	Integer bound = NumberUtils<Integer>::divideUp(constraint.getConstant() - sum, propagatingVarCoefficient);
-			d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(d_propagationVariable, bound, constraintRef);
+        	Integer bound = NumberUtils<Integer>::divideUp(constraint.getConstant() - max, propagatingVarCoefficient);
+			d_solverState.template enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(d_propagationVariable, bound, constraintRef);
 		} else {
-	    	Integer bound = NumberUtils<Integer>::divideDown(constraint.getConstant() - sum, propagatingVarCoefficient);
-			d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(d_propagationVariable, bound, constraintRef);
+	    	Integer bound = NumberUtils<Integer>::divideDown(constraint.getConstant() - max, propagatingVarCoefficient);
+			d_solverState.template enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(d_propagationVariable, bound, constraintRef);
 		}
     }
 }
 
 
-void IntegerConstraintPropagator::repropagate(ConstraintRef constraintRef) {
+template<ConstraintType type>
+void IntegerConstraintPropagator<type>::repropagate(ConstraintRef constraintRef) {
 
-	const IntegerConstraint& constraint = d_constraintManager.get<ConstraintTypeInteger>(constraintRef);
+	const constraint_type& constraint = d_constraintManager.template get<type>(constraintRef);
 
 	// Propagate something
-	Integer sum = 0;
-	Integer propagatingVarCoefficient;
-	for (unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
-		const IntegerConstraintLiteral& literal = constraint.getLiteral(i);
-    	Variable var = literal.getVariable();
-    	if (var == d_propagationVariable) {
-    		propagatingVarCoefficient = literal.getCoefficient();
-    		continue;
-    	}
-    	if (literal.getCoefficient() > 0) {
-    		if (d_solverState.hasUpperBound(var)) {
-    			sum += d_solverState.getUpperBound<TypeInteger>(var) * literal.getCoefficient();
-    		} else {
-    			// Propagation not possible
-    			return;
-    		}
-    	} else {
-    		if (d_solverState.hasLowerBound(var)) {
-    			sum += d_solverState.getLowerBound<TypeInteger>(var) * literal.getCoefficient();
-    		} else {
-    			// Propagation not possible
-    			return;
-    		}
-    	}
+	Integer sum;
+	const coefficient_type& propagatingVarCoefficient = getCoefficient(constraint, d_propagationVariable);
+	if (!getMaxWithout(constraint, d_propagationVariable, propagatingVarCoefficient, sum)) {
+		// Propagation not possible
+		return;
 	}
 
 	// Try and propagate something
 	if (propagatingVarCoefficient > 0) {
     	Integer bound = NumberUtils<Integer>::divideUp(constraint.getConstant() - sum, propagatingVarCoefficient);
-		if (!d_solverState.hasLowerBound(d_propagationVariable) || d_solverState.getLowerBound<TypeInteger>(d_propagationVariable) < bound) {
-			d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(d_propagationVariable, bound, constraintRef);
+		if (!d_solverState.hasLowerBound(d_propagationVariable) || d_solverState.template getLowerBound<TypeInteger>(d_propagationVariable) < bound) {
+			d_solverState.template enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(d_propagationVariable, bound, constraintRef);
 		}
 	} else {
     	Integer bound = NumberUtils<Integer>::divideDown(constraint.getConstant() - sum, propagatingVarCoefficient);
-		if (!d_solverState.hasUpperBound(d_propagationVariable) || d_solverState.getUpperBound<TypeInteger>(d_propagationVariable) > bound) {
-			d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(d_propagationVariable, bound, constraintRef);
+		if (!d_solverState.hasUpperBound(d_propagationVariable) || d_solverState.template getUpperBound<TypeInteger>(d_propagationVariable) > bound) {
+			d_solverState.template enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(d_propagationVariable, bound, constraintRef);
 		}
 	}
 }
 
-void IntegerConstraintPropagator::removeConstraint(ConstraintRef constraintRef) {
+template<ConstraintType type>
+void IntegerConstraintPropagator<type>::removeConstraint(ConstraintRef constraintRef) {
 
-    const IntegerConstraint& constraint = d_constraintManager.get<ConstraintTypeInteger>(constraintRef);
+    const constraint_type& constraint = d_constraintManager.template get<type>(constraintRef);
     assert(!constraint.inUse());
+    const literal_storage literals = constraint.getLiterals();
     for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
-        const IntegerConstraintLiteral& literal = constraint.getLiteral(i);
-        Variable variable = literal.getVariable();
+        Variable variable = literals.getVariable(i);
         // Remove from the appears list
-        d_watchManager.needsCleanup<MODIFICATION_ANY>(variable);
+        d_watchManager.template needsCleanup<MODIFICATION_ANY>(variable);
     }
 }
 
-void IntegerConstraintPropagator::bound(Variable var) {
+template<ConstraintType type>
+void IntegerConstraintPropagator<type>::bound(Variable var) {
 
 	CUTSAT_TRACE_FN("propagator::integer") << var << std::endl;
 
@@ -199,49 +194,17 @@ void IntegerConstraintPropagator::bound(Variable var) {
     for(; it != it_end; ++ it) {
 
         ConstraintRef constraintRef = *it;
-		IntegerConstraint& constraint = d_constraintManager.get<ConstraintTypeInteger>(constraintRef);
+		constraint_type& constraint = d_constraintManager.template get<type>(constraintRef);
 
         if (constraint.isDeleted()) continue;
         *it_copy++ = constraintRef;
 
 		CUTSAT_TRACE_FN("propagator::integer") << constraint << std::endl;
 
-		// ax >= c - S, where S is the biggest estimate
-		// Compute the upper bound of the sum of other variables
-		Integer sum = 0;
-		bool doBounding = true;
-		int varIndex = -1;
-		Integer varCoefficient = 0;
-		for(unsigned lit = 0, i_end = constraint.getSize(); lit < i_end; ++ lit) {
-            const IntegerConstraintLiteral& literal = constraint.getLiteral(lit);
-			Variable literalVariable = literal.getVariable();
-			const Integer& coefficient = literal.getCoefficient();
-			if (literalVariable != var) {
-				if (coefficient > 0) {
-					// ax >= c - by, where b > 0 => we need to get upper bound
-					if (d_solverState.hasUpperBound(literalVariable)) {
-						sum += coefficient * d_solverState.getUpperBound<TypeInteger>(literalVariable);
-					} else {
-						constraint.swapLiterals(0, lit);
-						doBounding = false;
-                        break;
-                    }
-				} else {
-					// ax >= c + by, where b > 0 =? we need to get lower boud
-					if (d_solverState.hasLowerBound(literalVariable)) {
-						sum += coefficient * d_solverState.getLowerBound<TypeInteger>(literalVariable);
-					} else {
-						constraint.swapLiterals(0, lit);
-						doBounding = false;
-                        break;
-					}
-				}
-			} else {
-				varIndex = lit;
-				varCoefficient = literal.getCoefficient();
-			}
-		}
-		assert(!doBounding || varIndex >= 0);
+		// ax >= c - S, where S is the biggest estimate of the sum of other variables
+		const coefficient_type& varCoefficient = getCoefficient(constraint, var);
+		Integer sum;
+		bool doBounding = getMaxWithout(constraint, var, varCoefficient, sum);
 
         if (doBounding) {
 			// We have (1) ax >= c - sum or (2) -ax >= c - sum
@@ -270,16 +233,147 @@ void IntegerConstraintPropagator::bound(Variable var) {
 
 
 	if (lowerBoundSet) {
-		if (!d_solverState.hasLowerBound(var) || bestLowerBound > d_solverState.getLowerBound<TypeInteger>(var)) {
+		if (!d_solverState.hasLowerBound(var) || bestLowerBound > d_solverState.template getLowerBound<TypeInteger>(var)) {
 			CUTSAT_TRACE("propagator::integer") << var << " >= " << bestLowerBound << std::endl;
-			d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(var, bestLowerBound, bestLowerBoundConstraint);
+			d_solverState.template enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(var, bestLowerBound, bestLowerBoundConstraint);
 		}
 	}
 	if (UpperBoundSet) {
-		if (!d_solverState.hasUpperBound(var) || bestUpperBound < d_solverState.getUpperBound<TypeInteger>(var)) {
+		if (!d_solverState.hasUpperBound(var) || bestUpperBound < d_solverState.template getUpperBound<TypeInteger>(var)) {
 			CUTSAT_TRACE("propagator::integer") << var << " <= " << bestUpperBound << std::endl;
-			d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(var, bestUpperBound, bestUpperBoundConstraint);
+			d_solverState.template enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(var, bestUpperBound, bestUpperBoundConstraint);
+		}
+	}
+}
+
+template<ConstraintType type>
+void IntegerConstraintPropagator<type>::propagateEvent(Variable triggerVar, VariableModificationType eventType) {
+
+	CUTSAT_TRACE_FN("propagator::integer") << triggerVar << " " << eventType << std::endl;
+
+	// A new upper bound lowers the maximum with positive coefficients, a new lower bound with the negative ones (flagged)
+	bool positive = eventType == MODIFICATION_UPPER_BOUND_REFINE;
+
+	WatchList& watchList = d_watchManager.getWatchList(triggerVar, MODIFICATION_ANY);
+	for (unsigned i = 0; i < watchList.getSize() && !d_solverState.inConflict(); ++ i) {
+		ConstraintRef constraintRef = watchList[i];
+		if (ConstraintManager::getFlag(constraintRef) == positive) {
+			continue;
+		}
+		constraintRef = ConstraintManager::unsetFlag(constraintRef);
+		if (d_constraintManager.template get<type>(constraintRef).isDeleted()) {
+			continue;
+		}
+		propagateConstraint(constraintRef);
+	}
+}
+
+template<ConstraintType type>
+void IntegerConstraintPropagator<type>::propagateConstraint(ConstraintRef constraintRef) {
+
+	const constraint_type& constraint = d_constraintManager.template get<type>(constraintRef);
+
+	// Nothing to propagate if the maximum is unbounded, or any literal can go to its worst
+	const activity_data& activity = constraint.getAdditionalData();
+	if (activity.unbounded > 0) {
+		return;
+	}
+	Integer slack = activity.maxActivity - constraint.getConstant();
+	if (slack >= activity.maxCoefficient) {
+		return;
+	}
+	assert(activity.maxActivity == computeMax(constraint));
+
+	const literal_storage literals = constraint.getLiterals();
+
+	// Any variable with the coefficient bigger than the slack can be bounded: ax >= a*best(x) - slack
+	for (unsigned i = 0, i_end = constraint.getSize(); i < i_end && !d_solverState.inConflict(); ++ i) {
+		const coefficient_type& coefficient = literals.getCoefficient(i);
+		if (NumberUtils<Integer>::abs(coefficient) <= slack) {
+			continue;
+		}
+		Variable var = literals.getVariable(i);
+		if (coefficient > 0) {
+			propagateBound(constraintRef, var, coefficient, coefficient * d_solverState.template getUpperBound<TypeInteger>(var) - slack);
+		} else {
+			propagateBound(constraintRef, var, coefficient, coefficient * d_solverState.template getLowerBound<TypeInteger>(var) - slack);
 		}
 	}
 }
 
+template<ConstraintType type>
+const typename IntegerConstraintPropagator<type>::coefficient_type& IntegerConstraintPropagator<type>::getCoefficient(const constraint_type& constraint, Variable var) {
+	const literal_storage literals = constraint.getLiterals();
+	for (unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+		if (literals.getVariable(i) == var) {
+			return literals.getCoefficient(i);
+		}
+	}
+	assert(false);
+	return literals.getCoefficient(0);
+}
+
+template<ConstraintType type>
+bool IntegerConstraintPropagator<type>::getMaxWithout(const constraint_type& constraint, Variable var, const coefficient_type& coefficient, Integer& max) {
+	const activity_data& activity = constraint.getAdditionalData();
+	// The best value of var, if known, is part of the activity
+	bool bounded = coefficient > 0 ? d_solverState.hasUpperBound(var) : d_solverState.hasLowerBound(var);
+	if (activity.unbounded > (bounded ? 0 : 1)) {
+		return false;
+	}
+	max = activity.maxActivity;
+	if (bounded) {
+		max -= coefficient * (coefficient > 0 ?
+				d_solverState.template getUpperBound<TypeInteger>(var) :
+				d_solverState.template getLowerBound<TypeInteger>(var));
+	}
+	assert(max + (bounded ? coefficient * (coefficient > 0 ?
+			d_solverState.template getUpperBound<TypeInteger>(var) :
+			d_solverState.template getLowerBound<TypeInteger>(var)) : Integer(0)) == computeMax(constraint));
+	return true;
+}
+
+template<ConstraintType type>
+Integer IntegerConstraintPropagator<type>::computeMax(const constraint_type& constraint) {
+	Integer max = 0;
+	const literal_storage literals = constraint.getLiterals();
+	for (unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+		Variable var = literals.getVariable(i);
+		const coefficient_type& coefficient = literals.getCoefficient(i);
+		if (coefficient > 0 && d_solverState.hasUpperBound(var)) {
+			max += coefficient * d_solverState.template getUpperBound<TypeInteger>(var);
+		} else if (coefficient < 0 && d_solverState.hasLowerBound(var)) {
+			max += coefficient * d_solverState.template getLowerBound<TypeInteger>(var);
+		}
+	}
+	return max;
+}
+
+template<ConstraintType type>
+template<typename Coefficient>
+void IntegerConstraintPropagator<type>::propagateBound(ConstraintRef constraintRef, Variable var, const Coefficient& coefficient, const Integer& rhs) {
+
+	// Assigned variables are left alone, conflicts with decisions are found when bounding the other variables
+	if (d_solverState.isAssigned(var)) {
+		return;
+	}
+
+	if (coefficient > 0) {
+		Integer bound = NumberUtils<Integer>::divideUp(rhs, coefficient);
+		if (d_solverState.hasUpperBound(var) && bound >= d_solverState.template getUpperBound<TypeInteger>(var)) {
+			CUTSAT_TRACE("propagator::integer") << var << " >= " << bound << std::endl;
+			d_solverState.template enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(var, bound, constraintRef);
+		}
+	} else {
+		Integer bound = NumberUtils<Integer>::divideDown(rhs, coefficient);
+		if (d_solverState.hasLowerBound(var) && bound <= d_solverState.template getLowerBound<TypeInteger>(var)) {
+			CUTSAT_TRACE("propagator::integer") << var << " <= " << bound << std::endl;
+			d_solverState.template enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(var, bound, constraintRef);
+		}
+	}
+}
+
+namespace cutsat {
+template class IntegerConstraintPropagator<ConstraintTypeInteger>;
+template class IntegerConstraintPropagator<ConstraintTypeInteger64>;
+}
@@ -16,22 +16,82 @@
  * You should have received a copy of the GNU General Public License
  * along with cutsat.  If not, see <http://www.gnu.org/licenses/>.
  */
-
 #pragma once
 
 #include "propagators/propagator.h"
 
 namespace cutsat {
 
-class IntegerConstraintPropagator : public Propagator<ConstraintTypeInteger> {
+/**
+ * Propagator for the linear integer constraints, with the coefficients either arbitrary precision
+ * (ConstraintTypeInteger) or native (ConstraintTypeInteger64).
+ */
+template<ConstraintType type>
+class IntegerConstraintPropagator : public Propagator<type> {
+
+    using Propagator<type>::d_constraintManager;
+    using Propagator<type>::d_solverState;
+    using Propagator<type>::d_watchManager;
+    using Propagator<type>::d_propagationVariable;
+
+public:
+
+    typedef typename Propagator<type>::literal_type literal_type;
+    typedef typename Propagator<type>::constant_type constant_type;
+    typedef TypedConstraint<type> constraint_type;
+    typedef typename constraint_type::literal_storage literal_storage;
+    /** The coefficients are of the same type as the constant */
+    typedef constant_type coefficient_type;
+
+private:
+
+    /**
+     * Returns the coefficient of the variable in the constraint.
+     */
+    const coefficient_type& getCoefficient(const constraint_type& constraint, Variable var);
+
+    /**
+     * Computes the maximal value of the constraint without the literal of the variable, from the activity.
+     * @return false if the maximum is unbounded
+     */
+    bool getMaxWithout(const constraint_type& constraint, Variable var, const coefficient_type& coefficient, Integer& max);
+
+    /**
+     * Computes the maximal value of the bounded literals from scratch, for checking the activity.
+     */
+    Integer computeMax(const constraint_type& constraint);
+
+    /**
+     * Propagates the constraint with respect to the current bounds. Given the maximal value of the left hand
+     * side, any variable with a coefficient bigger than the slack (maximum - constant) can be bounded. The
+     * maximum is the activity of the constraint, so this only costs the size of the constraint if something
+     * propagates.
+     */
+    void propagateConstraint(ConstraintRef constraintRef);
+
+    /**
+     * Propagates coefficient*var >= rhs as a bound on var if it fixes the value of var, or if it's in conflict.
+     * Refining the bounds by bits leads to arbitrarily long chains of propagations (e.g. x > y, y > x), these
+     * are left to bounding at decisions.
+     */
+    template<typename Coefficient>
+    void propagateBound(ConstraintRef constraintRef, Variable var, const Coefficient& coefficient, const Integer& rhs);
+
 public:
+
 	IntegerConstraintPropagator(ConstraintManager& constraintManager, SolverState& solverState)
-	: Propagator<ConstraintTypeInteger>(constraintManager, solverState) { }
-	PreprocessStatus preprocess(std::vector<literal_type>& literals, Integer& constant, int zeroLevelIndex);
+	: Propagator<type>(constraintManager, solverState) { }
+	PreprocessStatus preprocess(std::vector<literal_type>& literals, constant_type& constant, int zeroLevelIndex);
     void attachConstraint(ConstraintRef constraintRef);
     void removeConstraint(ConstraintRef constraintRef);
     void repropagate(ConstraintRef constraintRef);
     void bound(Variable var);
+
+    /**
+     * Propagates the constraints whose maximal value decreased with the bound change. These are
+     * watched in the MODIFICATION_ANY lists, with the flag marking the negative coefficients.
+     */
+    void propagateEvent(Variable triggerVar, VariableModificationType eventType);
 };
 
 }
@@ -41,9 +41,10 @@ enum PreprocessStatus {
 };
 
 /**
- * General propagator.
+ * General propagator. The watches are plain constraint references, unless the propagator needs to keep
+ * more information with them.
  */
-template<ConstraintType type>
+template<ConstraintType type, typename Watch = ConstraintRef>
 class Propagator {
 
 protected:
@@ -55,7 +56,7 @@ protected:
     SolverState& d_solverState;
 
     /** The watch-list manager */
-    WatchListManager d_watchManager;
+    BasicWatchListManager<Watch> d_watchManager;
 
     /** The possible propagtation variable for re-propagation */
     Variable d_propagationVariable;
@@ -79,23 +80,36 @@ public:
         d_propagationVariable = var;
     }
 
+    /** Returns the bit of this propagator in the watch mask */
+    inline static unsigned char getWatchBit() {
+        return 1 << type;
+    }
+
+    inline void setWatchMask(WatchMask& watchMask) {
+        d_watchManager.setWatchMask(watchMask, getWatchBit());
+    }
+
+    inline void updateWatchMask(Variable var, VariableModificationType eventType) {
+        d_watchManager.updateWatchMask(var, eventType);
+    }
+
     inline void cleanAll() {
     	d_watchManager.cleanAll();
     }
 
-    inline void gcUpdate(const std::map<ConstraintRef, ConstraintRef>& reallocMap) {
-        d_watchManager.gcUpdate(reallocMap);
+    inline void gcUpdate() {
+        d_watchManager.gcUpdate();
     }
 
     void propagateEvent(Variable triggerVar, VariableModificationType eventType) {
 
     	// Get the watch list according to the event
-        WatchList& watchList = d_watchManager.getWatchList(triggerVar, eventType);
+        BasicWatchList<Watch>& watchList = d_watchManager.getWatchList(triggerVar, eventType);
 
         // Go through the watched constraints and call the appropriate propagator
-        WatchList::iterator watch_i = watchList.begin();
-        WatchList::iterator watch_j = watchList.begin();
-        WatchList::iterator watch_i_end = watchList.end();
+        typename BasicWatchList<Watch>::iterator watch_i = watchList.begin();
+        typename BasicWatchList<Watch>::iterator watch_j = watchList.begin();
+        typename BasicWatchList<Watch>::iterator watch_i_end = watchList.end();
         while (watch_i != watch_i_end) {
 
             // The constraint that is watching this event
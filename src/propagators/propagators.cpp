@@ -32,6 +32,42 @@ void PropagatorCollection::cancelUntil(int trailIndex) {
 	}
 }
 
+void PropagatorCollection::repropagate(ConstraintRef constraintRef, Variable var) {
+	unsigned oldTrailSize = d_solverState.getTrailSize();
+	switch (ConstraintManager::getType(constraintRef)) {
+		case ConstraintTypeClause:
+			boost::fusion::at_c<ConstraintTypeClause>(d_propagators).setPropagationVariable(var);
+			boost::fusion::at_c<ConstraintTypeClause>(d_propagators).repropagate(constraintRef);
+			break;
+		case ConstraintTypeCardinality:
+			boost::fusion::at_c<ConstraintTypeCardinality>(d_propagators).setPropagationVariable(var);
+			boost::fusion::at_c<ConstraintTypeCardinality>(d_propagators).repropagate(constraintRef);
+			break;
+		case ConstraintTypeInteger:
+			boost::fusion::at_c<ConstraintTypeInteger>(d_propagators).setPropagationVariable(var);
+			boost::fusion::at_c<ConstraintTypeInteger>(d_propagators).repropagate(constraintRef);
+			break;
+		case ConstraintTypeInteger64:
+			boost::fusion::at_c<ConstraintTypeInteger64>(d_propagators).setPropagationVariable(var);
+			boost::fusion::at_c<ConstraintTypeInteger64>(d_propagators).repropagate(constraintRef);
+			break;
+		case ConstraintTypePseudoBoolean:
+			boost::fusion::at_c<ConstraintTypePseudoBoolean>(d_propagators).setPropagationVariable(var);
+			boost::fusion::at_c<ConstraintTypePseudoBoolean>(d_propagators).repropagate(constraintRef);
+			break;
+		case ConstraintTypeBinaryClause:
+			boost::fusion::at_c<ConstraintTypeClause>(d_propagators).setPropagationVariable(var);
+			boost::fusion::at_c<ConstraintTypeClause>(d_propagators).repropagate(constraintRef);
+			break;
+		default:
+			assert(false);
+	}
+	// It propagated something again
+	if (oldTrailSize < d_solverState.getTrailSize()) {
+		addPropagation(constraintRef, oldTrailSize);
+	}
+}
+
 void PropagatorCollection::repropagate()
 {
     CUTSAT_TRACE_FN("propagators") << *this << std::endl;
@@ -41,28 +77,8 @@ void PropagatorCollection::repropagate()
 
 	// Try to repropagate the constraints
 	while (!d_toRepropagate.empty() && !d_solverState.inConflict()) {
-		unsigned oldTrailSize = d_solverState.getTrailSize();
 		RepropagationInfo& current = d_toRepropagate.back();
-		switch (ConstraintManager::getType(current.constraint)) {
-			case ConstraintTypeClause:
-				boost::fusion::at_c<ConstraintTypeClause>(d_propagators).setPropagationVariable(current.var);
-				boost::fusion::at_c<ConstraintTypeClause>(d_propagators).repropagate(current.constraint);
-				break;
-			case ConstraintTypeCardinality:
-				boost::fusion::at_c<ConstraintTypeClause>(d_propagators).setPropagationVariable(current.var);
-				boost::fusion::at_c<ConstraintTypeClause>(d_propagators).repropagate(current.constraint);
-				break;
-			case ConstraintTypeInteger:
-				boost::fusion::at_c<ConstraintTypeInteger>(d_propagators).setPropagationVariable(current.var);
-				boost::fusion::at_c<ConstraintTypeInteger>(d_propagators).repropagate(current.constraint);
-				break;
-			default:
-				assert(false);
-		}
-		// It propagated something again
-		if (oldTrailSize < d_solverState.getTrailSize()) {
-			d_repropagationList.push_back(RepropagationInfo(current.constraint, oldTrailSize, d_solverState.getTrail()[oldTrailSize].var));
-		}
+		repropagate(current.constraint, current.var);
 		// Remove from the list
 		d_toRepropagate.pop_back();
 	}
@@ -85,9 +101,21 @@ void PropagatorCollection::print(std::ostream& out) const {
 			case ConstraintTypeClause:
 				out << d_repropagationList[i].trailIndex << ": " << d_constraintManager.get<ConstraintTypeClause>(d_repropagationList[i].constraint) << std::endl;
 				break;
+			case ConstraintTypeCardinality:
+				out << d_repropagationList[i].trailIndex << ": " << d_constraintManager.get<ConstraintTypeCardinality>(d_repropagationList[i].constraint) << std::endl;
+				break;
 			case ConstraintTypeInteger:
 				out << d_repropagationList[i].trailIndex << ": " << d_constraintManager.get<ConstraintTypeInteger>(d_repropagationList[i].constraint) << std::endl;
 				break;
+			case ConstraintTypeInteger64:
+				out << d_repropagationList[i].trailIndex << ": " << d_constraintManager.get<ConstraintTypeInteger64>(d_repropagationList[i].constraint) << std::endl;
+				break;
+			case ConstraintTypePseudoBoolean:
+				out << d_repropagationList[i].trailIndex << ": " << d_constraintManager.get<ConstraintTypePseudoBoolean>(d_repropagationList[i].constraint) << std::endl;
+				break;
+			case ConstraintTypeBinaryClause:
+				out << d_repropagationList[i].trailIndex << ": " << d_constraintManager.getBinaryClause(d_repropagationList[i].constraint) << std::endl;
+				break;
 			default:
 				assert(false);
 		}
@@ -98,40 +126,38 @@ void PropagatorCollection::print(std::ostream& out) const {
 			case ConstraintTypeClause:
 				out << d_toRepropagate[i].trailIndex << ": " << d_constraintManager.get<ConstraintTypeClause>(d_toRepropagate[i].constraint) << std::endl;
 				break;
+			case ConstraintTypeCardinality:
+				out << d_toRepropagate[i].trailIndex << ": " << d_constraintManager.get<ConstraintTypeCardinality>(d_toRepropagate[i].constraint) << std::endl;
+				break;
 			case ConstraintTypeInteger:
 				out << d_toRepropagate[i].trailIndex << ": " << d_constraintManager.get<ConstraintTypeInteger>(d_toRepropagate[i].constraint) << std::endl;
 				break;
+			case ConstraintTypeInteger64:
+				out << d_toRepropagate[i].trailIndex << ": " << d_constraintManager.get<ConstraintTypeInteger64>(d_toRepropagate[i].constraint) << std::endl;
+				break;
+			case ConstraintTypePseudoBoolean:
+				out << d_toRepropagate[i].trailIndex << ": " << d_constraintManager.get<ConstraintTypePseudoBoolean>(d_toRepropagate[i].constraint) << std::endl;
+				break;
+			case ConstraintTypeBinaryClause:
+				out << d_toRepropagate[i].trailIndex << ": " << d_constraintManager.getBinaryClause(d_toRepropagate[i].constraint) << std::endl;
+				break;
 			default:
 				assert(false);
 		}
 	}
 }
 
-void PropagatorCollection::gcUpdate(const std::map<ConstraintRef, ConstraintRef>& reallocMap) {
+void PropagatorCollection::gcUpdate() {
 	// Update the propagators
-	boost::fusion::for_each(d_propagators, realloc_all(reallocMap));
+	boost::fusion::for_each(d_propagators, realloc_all());
 	// Update the repropagation constraints
 	for (unsigned i = 0; i < d_repropagationList.size(); ++ i) {
 		ConstraintRef& cref = d_repropagationList[i].constraint;
-		if (ConstraintManager::getFlag(cref)) {
-			cref = ConstraintManager::unsetFlag(cref);
-			assert(reallocMap.find(cref) != reallocMap.end());
-			cref = ConstraintManager::setFlag(reallocMap.find(cref)->second);
-		} else {
-			assert(reallocMap.find(cref) != reallocMap.end());
-			cref = reallocMap.find(cref)->second;
-		}
+		cref = d_constraintManager.gcRelocate(cref);
 	}
 	for (unsigned i = 0; i < d_toRepropagate.size(); ++ i) {
 		ConstraintRef& cref = d_toRepropagate[i].constraint;
-		if (ConstraintManager::getFlag(cref)) {
-			cref = ConstraintManager::unsetFlag(cref);
-			assert(reallocMap.find(cref) != reallocMap.end());
-			cref = ConstraintManager::setFlag(reallocMap.find(cref)->second);
-		} else {
-			assert(reallocMap.find(cref) != reallocMap.end());
-			cref = reallocMap.find(cref)->second;
-		}
+		cref = d_constraintManager.gcRelocate(cref);
 	}
 
 }
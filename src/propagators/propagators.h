@@ -22,6 +22,7 @@
 #include "propagators/clause_propagator.h"
 #include "propagators/cardinality_propagator.h"
 #include "propagators/integer_propagator.h"
+#include "propagators/pseudo_boolean_propagator.h"
 
 #include <boost/fusion/include/at_c.hpp>
 #include <boost/fusion/include/vector.hpp>
@@ -65,24 +66,50 @@ private:
     /** Solver we're using */
     SolverState& d_solverState;
 
+    /** The propagators watching each of the bound events of the variables */
+    WatchMask d_watchMask;
+
 	/** All the propagators indexed by the constraint type */
 	boost::fusion::vector<
 		ClauseConstraintPropagator,
 		CardinalityConstraintPropagator,
-		IntegerConstraintPropagator
+		IntegerConstraintPropagator<ConstraintTypeInteger>,
+		IntegerConstraintPropagator<ConstraintTypeInteger64>,
+		PseudoBooleanConstraintPropagator
 	> d_propagators;
 
 public:
 
+    /** The propagators that are cheap to run, these are run to fixpoint before the others */
+    static const unsigned char s_cheapPropagators =
+    	(1 << ConstraintTypeClause) | (1 << ConstraintTypeCardinality) | (1 << ConstraintTypePseudoBoolean);
+
+    /** The expensive propagators, run only when the cheap ones are done */
+    static const unsigned char s_expensivePropagators =
+    	(1 << ConstraintTypeInteger) | (1 << ConstraintTypeInteger64);
+
     PropagatorCollection(ConstraintManager& cm, SolverState& solverState)
     : d_constraintManager(cm),
       d_solverState(solverState),
       d_propagators(
     	ClauseConstraintPropagator(cm, solverState),
     	CardinalityConstraintPropagator(cm, solverState),
-    	IntegerConstraintPropagator(cm, solverState)
+    	IntegerConstraintPropagator<ConstraintTypeInteger>(cm, solverState),
+    	IntegerConstraintPropagator<ConstraintTypeInteger64>(cm, solverState),
+    	PseudoBooleanConstraintPropagator(cm, solverState)
       )
-    {}
+    {
+    	boost::fusion::for_each(d_propagators, set_watch_mask(d_watchMask));
+    }
+
+    struct set_watch_mask {
+    	WatchMask& watchMask;
+    	set_watch_mask(WatchMask& watchMask) : watchMask(watchMask) {}
+    	template<typename T>
+    	void operator() (T& t) const {
+    		t.setWatchMask(watchMask);
+    	}
+    };
 
     struct add_variable {
     	/** Variable to add */
@@ -99,6 +126,7 @@ public:
      * @param var
      */
     void addVariable(Variable var) {
+    	d_watchMask.addVariable(var);
     	boost::fusion::for_each(d_propagators, add_variable(var));
     }
 
@@ -131,19 +159,16 @@ public:
     }
 
     struct realloc_all {
-    	const std::map<ConstraintRef, ConstraintRef>& reallocMap;
-    	realloc_all(const std::map<ConstraintRef, ConstraintRef>& reallocMap)
-    	: reallocMap(reallocMap) {}
     	template<typename T>
     	void operator() (T& t) const {
-    		t.gcUpdate(reallocMap);
+    		t.gcUpdate();
     	}
     };
 
     /**
      * Updates all the constraints with their reallocated pointers.
      */
-    void gcUpdate(const std::map<ConstraintRef, ConstraintRef>& reallocMap);
+    void gcUpdate();
 
     /**
      * Attaches a constraint to the appropriate propagator.
@@ -158,6 +183,18 @@ public:
         }
     }
 
+    /**
+     * Propagates with a constraint that is already attached, as attachConstraint() does with a new one.
+     */
+    template<ConstraintType constraintType>
+    void repropagateConstraint(ConstraintRef constraintRef) {
+        unsigned oldTrailSize = d_solverState.getTrailSize();
+    	boost::fusion::at_c<constraintType>(d_propagators).repropagate(constraintRef);
+        if (oldTrailSize < d_solverState.getTrailSize()) {
+            d_repropagationList.push_back(RepropagationInfo(constraintRef, oldTrailSize, d_solverState.getTrail()[oldTrailSize].var));
+        }
+    }
+
     /**
      * Removes a constraint from the appropriate propagator.
      * @param constraintRef the constraint to remove
@@ -186,20 +223,27 @@ public:
     template<VariableModificationType eventType>
     struct propagate_event {
     	Variable triggerVar;
-    	propagate_event(Variable triggerVar) : triggerVar(triggerVar) {}
+    	unsigned char watching;
+    	propagate_event(Variable triggerVar, unsigned char watching) : triggerVar(triggerVar), watching(watching) {}
     	template<typename T>
     	void operator() (T& t) const {
-            CUTSAT_TRACE_FN("propagators");
-    		t.propagateEvent(triggerVar, eventType);
+    		if (watching & T::getWatchBit()) {
+                CUTSAT_TRACE_FN("propagators");
+    			t.propagateEvent(triggerVar, eventType);
+    			t.updateWatchMask(triggerVar, eventType);
+    		}
     	}
     };
 
     /**
-     * Calls the propagators on the specific event that happened on the triggerVar.
+     * Calls the given propagators that are watching the specific event that happened on the triggerVar.
      */
     template<VariableModificationType eventType>
-    void propagateEvent(Variable triggerVar) {
-    	boost::fusion::for_each(d_propagators, propagate_event<eventType>(triggerVar));
+    void propagateEvent(Variable triggerVar, unsigned char propagators) {
+    	unsigned char watching = d_watchMask.get(triggerVar, eventType) & propagators;
+    	if (watching) {
+    		boost::fusion::for_each(d_propagators, propagate_event<eventType>(triggerVar, watching));
+    	}
     }
 
     /**
@@ -207,6 +251,21 @@ public:
      */
     void repropagate();
 
+    /**
+     * Repropagates the constraint with the appropriate propagator, as the constraint that propagated the variable,
+     * and records it if it propagates again.
+     */
+    void repropagate(ConstraintRef constraintRef, Variable var);
+
+    /**
+     * Records a propagation done outside the propagators, so that it is repropagated if a backtrack undoes it.
+     * @param constraintRef the constraint that propagated
+     * @param trailIndex the trail index of the propagated bound
+     */
+    void addPropagation(ConstraintRef constraintRef, unsigned trailIndex) {
+        d_repropagationList.push_back(RepropagationInfo(constraintRef, trailIndex, d_solverState.getTrail()[trailIndex].var));
+    }
+
     /**
      * Passes the constraint to the appropriate propagator for preprocessing.
      */
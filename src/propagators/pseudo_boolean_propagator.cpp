@@ -0,0 +1,300 @@
+/**
+ * Copyright 2010 Dejan Jovanovic.
+ *
+ * This file is part of cutsat.
+ *
+ * Cutsat is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cutsat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cutsat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "propagators/pseudo_boolean_propagator.h"
+
+using namespace cutsat;
+
+TraceTag pseudoBooleanPropagator("propagator::pseudo_boolean");
+
+/**
+ * Returns true if the literal with the given coefficient is false, i.e. if x = 0 for a positive
+ * coefficient and x = 1 for a negative one.
+ */
+static inline bool isFalse(const SolverState& state, Variable var, boost::int32_t coefficient) {
+	if (coefficient > 0) {
+		return state.getUpperBound<TypeInteger>(var) < 1;
+	} else {
+		return state.getLowerBound<TypeInteger>(var) > 0;
+	}
+}
+
+/**
+ * Returns the weight of the literal with the given coefficient.
+ */
+static inline boost::int32_t getWeight(boost::int32_t coefficient) {
+	return coefficient > 0 ? coefficient : -coefficient;
+}
+
+// Sort the literals as:
+// * not false first, by descending weight
+// * false sorted descending trail index
+struct pseudo_boolean_sort {
+	const SolverState& d_state;
+	pseudo_boolean_sort(const SolverState& state)
+	: d_state(state) {}
+
+	bool operator () (const PseudoBooleanConstraintLiteral& l1, const PseudoBooleanConstraintLiteral& l2) const {
+		bool l1_false = isFalse(d_state, l1.getVariable(), l1.getCoefficient());
+		bool l2_false = isFalse(d_state, l2.getVariable(), l2.getCoefficient());
+		if (l1_false != l2_false) {
+			return l2_false;
+		}
+		if (!l1_false) {
+			return getWeight(l1.getCoefficient()) > getWeight(l2.getCoefficient());
+		}
+		return d_state.getLastModificationTrailIndex<true>(l1.getVariable()) > d_state.getLastModificationTrailIndex<true>(l2.getVariable());
+	}
+};
+
+void PseudoBooleanConstraintPropagator::watch(const PseudoBooleanConstraint& constraint, unsigned i, ConstraintRef constraintRef) {
+	const PseudoBooleanConstraint::literal_storage literals = constraint.getLiterals();
+	if (literals.getCoefficient(i) > 0) {
+		// We want to know when x becomes false, so we watch the upper bound
+		d_watchManager.getWatchList(literals.getVariable(i), MODIFICATION_UPPER_BOUND_REFINE).push_back<true>(constraintRef);
+	} else {
+		// We want to know when (1-x) becomes false, i.e. x becomes true, so we watch the lower bound
+		d_watchManager.getWatchList(literals.getVariable(i), MODIFICATION_LOWER_BOUND_REFINE).push_back<false>(constraintRef);
+	}
+}
+
+void PseudoBooleanConstraintPropagator::propagateLiterals(ConstraintRef constraintRef, Integer64 slack, unsigned count) {
+
+	const PseudoBooleanConstraint& constraint = d_constraintManager.get<ConstraintTypePseudoBoolean>(constraintRef);
+	const PseudoBooleanConstraint::literal_storage literals = constraint.getLiterals();
+
+	CUTSAT_TRACE("propagator::pseudo_boolean") << constraint << " with slack " << slack << std::endl;
+
+	if (slack < 0) {
+		// In conflict, we bound an unassigned literal out of its domain, as the integer propagator would
+		for (unsigned i = 0; i < count; ++ i) {
+			boost::int32_t coefficient = literals.getCoefficient(i);
+			Variable var = literals.getVariable(i);
+			if (!d_solverState.isAssigned(var) && !isFalse(d_solverState, var, coefficient)) {
+				// w*l >= degree - (others) gives l >= 1 + ceil(-slack/w)
+				Integer64 bound = 1 + (-slack + getWeight(coefficient) - 1) / getWeight(coefficient);
+				if (coefficient > 0) {
+					d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(var, bound, constraintRef);
+				} else {
+					d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(var, 1 - bound, constraintRef);
+				}
+				return;
+			}
+		}
+		// Otherwise we make true a literal that was propagated to false, the decisions can't be resolved
+		unsigned conflictLiteral = constraint.getSize();
+		for (unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+			Variable var = literals.getVariable(i);
+			if (isFalse(d_solverState, var, literals.getCoefficient(i))) {
+				conflictLiteral = i;
+				if (!d_solverState.isDecided(var)) {
+					break;
+				}
+			}
+		}
+		assert(conflictLiteral < constraint.getSize());
+		if (literals.getCoefficient(conflictLiteral) > 0) {
+			d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(literals.getVariable(conflictLiteral), 1, constraintRef);
+		} else {
+			d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(literals.getVariable(conflictLiteral), 0, constraintRef);
+		}
+		return;
+	}
+
+	for (unsigned i = 0; i < count && !d_solverState.inConflict(); ++ i) {
+		boost::int32_t coefficient = literals.getCoefficient(i);
+		Variable var = literals.getVariable(i);
+		if (getWeight(coefficient) <= slack || d_solverState.isAssigned(var)) {
+			continue;
+		}
+		if (coefficient > 0) {
+			d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(var, 1, constraintRef);
+		} else {
+			d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(var, 0, constraintRef);
+		}
+	}
+}
+
+void PseudoBooleanConstraintPropagator::repropagate(ConstraintRef constraintRef) {
+
+	const PseudoBooleanConstraint& constraint = d_constraintManager.get<ConstraintTypePseudoBoolean>(constraintRef);
+	const PseudoBooleanConstraint::literal_storage literals = constraint.getLiterals();
+	const watched_sum_data& watches = constraint.getAdditionalData();
+
+	CUTSAT_TRACE("propagator::pseudo_boolean") << d_propagationVariable << "," << constraint << std::endl;
+
+	// Compute the slack over all the literals
+	Integer64 slack = -watches.degree;
+	for (unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+		boost::int32_t coefficient = literals.getCoefficient(i);
+		if (!isFalse(d_solverState, literals.getVariable(i), coefficient)) {
+			slack += getWeight(coefficient);
+		}
+	}
+
+	if (slack < watches.maxWeight) {
+		propagateLiterals(constraintRef, slack, constraint.getSize());
+	}
+}
+
+bool PseudoBooleanConstraintPropagator::propagate(Variable var, ConstraintRef constraintRef, VariableModificationType eventType) {
+
+	assert(eventType == MODIFICATION_LOWER_BOUND_REFINE || eventType == MODIFICATION_UPPER_BOUND_REFINE);
+
+	constraintRef = ConstraintManager::unsetFlag(constraintRef);
+	PseudoBooleanConstraint& constraint = d_constraintManager.get<ConstraintTypePseudoBoolean>(constraintRef);
+	const PseudoBooleanConstraint::literal_storage literals = constraint.getLiterals();
+	watched_sum_data& watches = constraint.getAdditionalData();
+
+	CUTSAT_TRACE("propagator::pseudo_boolean") << var << "," << constraint << std::endl;
+
+	// Find the falsified literal and sum up the watched literals that are not false
+	int falseLiteral = -1;
+	Integer64 sum = 0;
+	for (unsigned i = 0; i < watches.watched; ++ i) {
+		Variable literalVariable = literals.getVariable(i);
+		boost::int32_t coefficient = literals.getCoefficient(i);
+		if (literalVariable == var) {
+			falseLiteral = i;
+		} else if (!isFalse(d_solverState, literalVariable, coefficient)) {
+			sum += getWeight(coefficient);
+		}
+	}
+	assert(falseLiteral >= 0);
+	assert(isFalse(d_solverState, var, literals.getCoefficient(falseLiteral)));
+
+	// Watch new literals until we are above the degree + max(w)
+	Integer64 target = watches.degree + watches.maxWeight;
+	for (unsigned i = watches.watched, i_end = constraint.getSize(); i < i_end && sum < target; ++ i) {
+		boost::int32_t coefficient = literals.getCoefficient(i);
+		if (!isFalse(d_solverState, literals.getVariable(i), coefficient)) {
+			constraint.swapLiterals(i, watches.watched);
+			watch(constraint, watches.watched ++, constraintRef);
+			sum += getWeight(coefficient);
+		}
+	}
+
+	// If we have enough, we can stop watching the false literal
+	if (sum >= target) {
+		constraint.swapLiterals(falseLiteral, -- watches.watched);
+		return true;
+	}
+
+	// All the literals that are not false are watched, so we keep the watch and propagate
+	propagateLiterals(constraintRef, sum - watches.degree, watches.watched);
+	return false;
+}
+
+void PseudoBooleanConstraintPropagator::attachConstraint(ConstraintRef constraintRef) {
+	CUTSAT_TRACE_FN("propagator::pseudo_boolean");
+
+	// Get the constraint
+	PseudoBooleanConstraint& constraint = d_constraintManager.get<ConstraintTypePseudoBoolean>(constraintRef);
+	const PseudoBooleanConstraint::literal_storage literals = constraint.getLiterals();
+	watched_sum_data& watches = constraint.getAdditionalData();
+
+	// Normalize to w1*l1 + ... + wn*ln >= degree
+	watches = watched_sum_data();
+	watches.degree = constraint.getConstant();
+	for (unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+		boost::int32_t coefficient = literals.getCoefficient(i);
+		if (coefficient < 0) {
+			watches.degree -= coefficient;
+		}
+		watches.maxWeight = std::max(watches.maxWeight, getWeight(coefficient));
+	}
+
+	// Sort the literals in order to attach
+	pseudo_boolean_sort sorter(d_solverState);
+	constraint.sort(sorter);
+
+	CUTSAT_TRACE("propagator::pseudo_boolean") << "attaching: " << constraint << ", " << watches << std::endl;
+
+	// Watch the literals until their weight gets to degree + max(w). The false ones that are watched
+	// are the first to become not false on backtrack.
+	Integer64 target = watches.degree + watches.maxWeight;
+	Integer64 sum = 0, all = 0;
+	for (unsigned i = 0, i_end = constraint.getSize(); i < i_end && all < target; ++ i) {
+		boost::int32_t coefficient = literals.getCoefficient(i);
+		if (!isFalse(d_solverState, literals.getVariable(i), coefficient)) {
+			sum += getWeight(coefficient);
+		}
+		all += getWeight(coefficient);
+		watch(constraint, watches.watched ++, constraintRef);
+	}
+
+	// If the literals that are not false don't make it, we propagate
+	if (sum < target) {
+		CUTSAT_TRACE("propagator::pseudo_boolean") << "constraint propagates" << std::endl;
+		propagateLiterals(constraintRef, sum - watches.degree, watches.watched);
+	}
+}
+
+PreprocessStatus PseudoBooleanConstraintPropagator::preprocess(
+		std::vector<PseudoBooleanConstraintLiteral>& literals, constant_type& constant, int zeroLevelIndex) {
+
+	CUTSAT_TRACE_FN("propagator::pseudo_boolean") << "preprocessing: " << literals << " >= " << constant << std::endl;
+
+	// Remove the literals fixed at zero level, and compute the range of the left hand side
+	Integer64 min = 0, max = 0;
+	unsigned j = 0;
+	for (unsigned i = 0, i_end = literals.size(); i < i_end; ++ i) {
+		Variable var = literals[i].getVariable();
+		boost::int32_t coefficient = literals[i].getCoefficient();
+		if (d_solverState.isAssigned(var, zeroLevelIndex)) {
+			if (d_solverState.getValue<TypeInteger>(var, zeroLevelIndex) > 0) {
+				constant -= coefficient;
+			}
+			continue;
+		}
+		if (coefficient > 0) {
+			max += coefficient;
+		} else {
+			min += coefficient;
+		}
+		literals[j++] = literals[i];
+	}
+	literals.resize(j);
+
+	CUTSAT_TRACE("propagator::pseudo_boolean") << "preprocessing: " << literals << " >= " << constant << std::endl;
+
+	if (max < constant) {
+		return PREPROCESS_INCONSISTENT;
+	}
+	if (min >= constant) {
+		return PREPROCESS_TAUTOLOGY;
+	}
+
+	return PREPROCESS_OK;
+}
+
+void PseudoBooleanConstraintPropagator::removeConstraint(ConstraintRef constraintRef) {
+	const PseudoBooleanConstraint& constraint = d_constraintManager.get<ConstraintTypePseudoBoolean>(constraintRef);
+	assert(!constraint.inUse());
+	const PseudoBooleanConstraint::literal_storage literals = constraint.getLiterals();
+	for (unsigned i = 0, i_end = constraint.getAdditionalData().watched; i < i_end; ++ i) {
+		// Remove from the watch lists
+		if (literals.getCoefficient(i) > 0) {
+			d_watchManager.needsCleanup<MODIFICATION_UPPER_BOUND_REFINE>(literals.getVariable(i));
+		} else {
+			d_watchManager.needsCleanup<MODIFICATION_LOWER_BOUND_REFINE>(literals.getVariable(i));
+		}
+	}
+}
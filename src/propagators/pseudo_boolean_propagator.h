@@ -0,0 +1,59 @@
+/**
+ * Copyright 2010 Dejan Jovanovic.
+ *
+ * This file is part of cutsat.
+ *
+ * Cutsat is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cutsat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cutsat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "propagators/propagator.h"
+
+namespace cutsat {
+
+/**
+ * Specialization of the propagator for pseudo-Boolean constraints. The constraint is seen as a sum of
+ * weighted literals w1*l1 + ... + wn*ln >= degree, and we watch enough literals that are not false so
+ * that their sum is at least degree + max(w). As long as this holds, no literal can be propagated. Once
+ * a watched literal is falsified and not enough new watches can be found, all the non-false literals are
+ * watched and the ones with the weight above the slack get propagated (Chai and Kuehlmann).
+ */
+class PseudoBooleanConstraintPropagator : public Propagator<ConstraintTypePseudoBoolean> {
+
+	/**
+	 * Adds the watch on the literal i of the constraint.
+	 */
+	void watch(const PseudoBooleanConstraint& constraint, unsigned i, ConstraintRef constraintRef);
+
+	/**
+	 * Propagates the literals among the first count whose weight is bigger than the slack. The literals
+	 * that are not false must all be among them. If the slack is negative, sets up the conflict.
+	 */
+	void propagateLiterals(ConstraintRef constraintRef, Integer64 slack, unsigned count);
+
+public:
+	PseudoBooleanConstraintPropagator(ConstraintManager& constraintManager, SolverState& solverState)
+	: Propagator<ConstraintTypePseudoBoolean>(constraintManager, solverState) { }
+
+	void repropagate(ConstraintRef constraintRef);
+	bool propagate(Variable var, ConstraintRef constraintRef, VariableModificationType eventType);
+	void attachConstraint(ConstraintRef constraintRef);
+	PreprocessStatus preprocess(std::vector<literal_type>& literals, constant_type& constant, int zeroLevelIndex);
+	void removeConstraint(ConstraintRef constraintRef);
+};
+
+}
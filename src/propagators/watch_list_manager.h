@@ -26,9 +26,38 @@
 
 namespace cutsat {
 
-class WatchList {
+/**
+ * A watch that carries a literal of the watching clause. If the blocker is true the clause is satisfied,
+ * so the propagator can skip it without looking at the clause itself.
+ */
+struct blocked_watch {
+    /** The watching constraint */
+    ConstraintRef constraint;
+    /** A literal of the constraint */
+    ClauseConstraintLiteral blocker;
+
+    /** Default constructor for vectors and such */
+    blocked_watch()
+    : constraint(ConstraintManager::NullConstraint) {}
+
+    blocked_watch(ConstraintRef constraint, ClauseConstraintLiteral blocker)
+    : constraint(constraint), blocker(blocker) {}
+};
+
+/** Returns the constraint of a plain watch */
+inline ConstraintRef& getWatchConstraint(ConstraintRef& watch) {
+    return watch;
+}
 
-    typedef std::vector<ConstraintRef> container_class;
+/** Returns the constraint of a blocked watch */
+inline ConstraintRef& getWatchConstraint(blocked_watch& watch) {
+    return watch.constraint;
+}
+
+template<typename Watch>
+class BasicWatchList {
+
+    typedef std::vector<Watch> container_class;
 
     /** Marks if the list of watched constraints needs cleanup */
     bool d_needsCleanup;
@@ -39,18 +68,18 @@ class WatchList {
  public:
 
     /** Iterator to go through the watches */
-    typedef container_class::iterator iterator;
+    typedef typename container_class::iterator iterator;
     /** Const iterator to go through the watches */
-    typedef container_class::const_iterator const_iterator;
+    typedef typename container_class::const_iterator const_iterator;
 
     /** Iterator to go through the watches */
-    typedef container_class::reverse_iterator reverse_iterator;
+    typedef typename container_class::reverse_iterator reverse_iterator;
     /** Const iterator to go through the watches */
-    typedef container_class::const_reverse_iterator const_reverse_iterator;
+    typedef typename container_class::const_reverse_iterator const_reverse_iterator;
 
-    WatchList(): d_needsCleanup(false) {}
+    BasicWatchList(): d_needsCleanup(false) {}
 
-    ConstraintRef operator [] (size_t i) const {
+    const Watch& operator [] (size_t i) const {
         return d_watchedConstraints[i];
     }
 
@@ -70,10 +99,10 @@ class WatchList {
         assert(d_needsCleanup);
         unsigned i, i_end, j;
         for (i = j = 0, i_end = d_watchedConstraints.size(); i < i_end; ++ i) {
-            ConstraintRef constraint = d_watchedConstraints[i];
-            // This is safe as all the constraint types share the same initial header
-            if (!cm.get<ConstraintTypeInteger>(constraint).isDeleted()) {
-                d_watchedConstraints[j++] = constraint;
+            ConstraintRef constraint = getWatchConstraint(d_watchedConstraints[i]);
+            // This is safe as all the constraint types share the same initial header (binary clauses are never deleted)
+            if (ConstraintManager::isBinaryClause(constraint) || !cm.get<ConstraintTypeInteger>(constraint).isDeleted()) {
+                d_watchedConstraints[j++] = d_watchedConstraints[i];
             } else {
             	assert(!cm.get<ConstraintTypeInteger>(constraint).inUse());
             }
@@ -91,6 +120,10 @@ class WatchList {
         }
     }
 
+    void push_back(const Watch& watch) {
+        d_watchedConstraints.push_back(watch);
+    }
+
     void resize(iterator newEnd) {
         d_watchedConstraints.resize(newEnd - begin());
     }
@@ -128,19 +161,74 @@ class WatchList {
     }
 };
 
+/** The watch lists of plain constraint references */
+typedef BasicWatchList<ConstraintRef> WatchList;
+
+/**
+ * For each variable and bound event, the bits of the propagators that might be watching it, so that the
+ * events are only dispatched to these. A bit is set whenever the propagator gets the watch list, and
+ * cleared when the propagator is found not to be watching anymore.
+ */
+class WatchMask {
+
+    /** The bits, indexed by variables (one per bound event) */
+    std::vector<unsigned char> d_mask;
+
+    /** Index of the bound event of the variable */
+    static size_t getIndex(Variable var, VariableModificationType eventType) {
+        assert(eventType == MODIFICATION_LOWER_BOUND_REFINE || eventType == MODIFICATION_UPPER_BOUND_REFINE);
+        return 2*var.getId() + eventType;
+    }
+
+public:
+
+    void addVariable(Variable var) {
+        size_t neededSize = 2*(var.getId() + 1);
+        if (neededSize > d_mask.size()) {
+            d_mask.resize(neededSize, 0);
+        }
+    }
+
+    /** Returns the bits of the propagators watching the event */
+    unsigned char get(Variable var, VariableModificationType eventType) const {
+        return d_mask[getIndex(var, eventType)];
+    }
+
+    /** Marks the propagators as watching the event, any event marks both bounds */
+    void set(Variable var, VariableModificationType eventType, unsigned char bits) {
+        if (eventType == MODIFICATION_ANY) {
+            d_mask[getIndex(var, MODIFICATION_LOWER_BOUND_REFINE)] |= bits;
+            d_mask[getIndex(var, MODIFICATION_UPPER_BOUND_REFINE)] |= bits;
+        } else {
+            d_mask[getIndex(var, eventType)] |= bits;
+        }
+    }
+
+    /** Marks the propagators as not watching the event */
+    void unset(Variable var, VariableModificationType eventType, unsigned char bits) {
+        d_mask[getIndex(var, eventType)] &= ~bits;
+    }
+};
 
-class WatchListManager {
+template<typename Watch>
+class BasicWatchListManager {
 
     /** Watchlist indexed by variables (one per type of event) */
-    std::vector<WatchList> d_watchLists;
+    std::vector< BasicWatchList<Watch> > d_watchLists;
 
     /** The constraint manager (needed for cleanup) */
     const ConstraintManager& d_cm;
 
+    /** The mask to mark the watched events in (if any) */
+    WatchMask* d_watchMask;
+
+    /** The bit of the owner in the mask */
+    unsigned char d_watchBit;
+
 public:
 
-    WatchListManager(const ConstraintManager& cm)
-    : d_cm(cm) {}
+    BasicWatchListManager(const ConstraintManager& cm)
+    : d_cm(cm), d_watchMask(NULL), d_watchBit(0) {}
 
     void addVariable(Variable var) {
         size_t neededSize = (var.getId() + 1) * MODIFICATION_COUNT;
@@ -149,14 +237,38 @@ public:
         }
     }
 
-    WatchList& getWatchList(Variable var, VariableModificationType eventType) {
-        WatchList& list = d_watchLists[var.getId()*MODIFICATION_COUNT + eventType];
+    /**
+     * Sets the mask to mark the watched events in, with the given bit.
+     */
+    void setWatchMask(WatchMask& watchMask, unsigned char watchBit) {
+        d_watchMask = &watchMask;
+        d_watchBit = watchBit;
+    }
+
+    BasicWatchList<Watch>& getWatchList(Variable var, VariableModificationType eventType) {
+        BasicWatchList<Watch>& list = d_watchLists[var.getId()*MODIFICATION_COUNT + eventType];
         if (list.needsCleanup()) {
             list.clean(d_cm);
         }
+        // The list might be getting new watches
+        if (d_watchMask != NULL) {
+            d_watchMask->set(var, eventType, d_watchBit);
+        }
         return list;
     }
 
+    /**
+     * Clears the bit of the bound event in the mask if there are no watches for it, neither in the list of
+     * the event nor in the list of any event.
+     */
+    void updateWatchMask(Variable var, VariableModificationType eventType) {
+        if (d_watchMask != NULL &&
+            d_watchLists[var.getId()*MODIFICATION_COUNT + eventType].getSize() == 0 &&
+            d_watchLists[var.getId()*MODIFICATION_COUNT + MODIFICATION_ANY].getSize() == 0) {
+            d_watchMask->unset(var, eventType, d_watchBit);
+        }
+    }
+
     template<VariableModificationType eventType>
     void needsCleanup(Variable var) {
         unsigned index = var.getId()*MODIFICATION_COUNT + eventType;
@@ -171,24 +283,21 @@ public:
     	}
     }
 
-    void gcUpdate(const std::map<ConstraintRef, ConstraintRef>& reallocMap) {
+    void gcUpdate() {
     	for(unsigned list = 0, list_end = d_watchLists.size(); list < list_end; ++ list) {
-    		WatchList& watchList = d_watchLists[list];
+    		BasicWatchList<Watch>& watchList = d_watchLists[list];
     		assert(!watchList.needsCleanup());
     		// Now update the new constraints
-    		WatchList::iterator it = watchList.begin();
-    		WatchList::iterator it_end = watchList.end();
+    		typename BasicWatchList<Watch>::iterator it = watchList.begin();
+    		typename BasicWatchList<Watch>::iterator it_end = watchList.end();
     		for(; it != it_end; ++ it) {
-    			if (ConstraintManager::getFlag(*it)) {
-    				assert(reallocMap.find(ConstraintManager::unsetFlag(*it)) != reallocMap.end());
-    				*it = ConstraintManager::setFlag(reallocMap.find(ConstraintManager::unsetFlag(*it))->second);
-    			} else {
-    				assert(reallocMap.find(*it) != reallocMap.end());
-    				*it = reallocMap.find(*it)->second;
-    			}
+    			getWatchConstraint(*it) = d_cm.gcRelocate(getWatchConstraint(*it));
     		}
     	}
     }
 };
 
+/** The watch list manager of plain constraint references */
+typedef BasicWatchListManager<ConstraintRef> WatchListManager;
+
 }
@@ -20,6 +20,7 @@
 #include "util/config.h"
 #include "util/scoped.h"
 #include "solver/solver.h"
+#include <algorithm>
 
 using namespace std;
 using namespace cutsat;
@@ -34,6 +35,9 @@ void Solver::analyzeConflict() {
     Scoped<bool> disablePropagation(d_disablePropagation);
     d_disablePropagation = true;
 
+    // Big temporaries are recycled through the pool, trim it once done
+    BigIntegerPool::Scope bigIntegerPoolScope;
+
     if (d_solverStats.conflicts == 0) {
         Trace::enableAll();
         d_verbosity = VERBOSITY_EXTREME;
@@ -43,6 +47,14 @@ void Solver::analyzeConflict() {
     // We ensvisioned, so we must check again
     while (d_state.inConflict()) {
 
+        // If only clauses are involved, learn a clause as in CDCL
+        if (analyzeConflictClausal()) {
+            if (d_status == Unsatisfiable) {
+                return;
+            }
+            continue;
+        }
+
         // Clear the conflict variables
         d_conflictVariables.clear();
 
@@ -56,11 +68,11 @@ void Solver::analyzeConflict() {
         Variable conflictVariable = d_state.getConflictVariable();
 
         // Map from variables to coefficients for the lower bound
-        constraint_coefficient_map lowerBoundCoefficients;
+        constraint_coefficient_map& lowerBoundCoefficients = d_lowerBoundCoefficients;
         // Map from variables to coefficients for the upper bound
-        constraint_coefficient_map upperBoundCoefficients;
+        constraint_coefficient_map& upperBoundCoefficients = d_upperBoundCoefficients;
         // Map from variable to coefficients for the resulting constraint
-        constraint_coefficient_map resultCoefficients;
+        constraint_coefficient_map& resultCoefficients = d_resultCoefficients;
 
         // Constants
         Integer cLower, cUpper, resultConstant;
@@ -71,8 +83,8 @@ void Solver::analyzeConflict() {
 
         // We start by taking resolvent to be the one of the constraints (any strategy is better than no strategy)
         VariableModificationType resolvent;
-        if (NumberUtils<Integer>::abs(lowerBoundCoefficients.coefficients[conflictVariable]) <
-            NumberUtils<Integer>::abs(upperBoundCoefficients.coefficients[conflictVariable])) {
+        if (NumberUtils<Integer>::abs(lowerBoundCoefficients[conflictVariable]) <
+            NumberUtils<Integer>::abs(upperBoundCoefficients[conflictVariable])) {
             resolvent = MODIFICATION_LOWER_BOUND_REFINE;
         } else {
             resolvent = MODIFICATION_UPPER_BOUND_REFINE;
@@ -135,6 +147,17 @@ void Solver::analyzeConflict() {
             // Get the top decision variable and the top trail index at the previous level to backtrack to
             int topTrailIndex;
             getTopTrailInfo(resultCoefficients, conflictVariable, topTrailIndex);
+            // If the jump is too far back, only undo the current level and propagate the cut out of order. If the top
+            // variable is not assigned, none of the bounds in the resolvent are above the top index, so this keeps
+            // the resolvent as it is.
+            if (d_chronologicalBacktrackLevels > 0 && topTrailIndex >= 0 && !d_state.isAssigned(conflictVariable)) {
+                const SearchTrail& trail = d_state.getTrail();
+                unsigned level = trail.getDecisionLevel();
+                if (level - trail.getLevelOfTrailIndex(topTrailIndex) > d_chronologicalBacktrackLevels) {
+                    topTrailIndex = trail.getTrailIndexOfLevel(level - 1);
+                    d_solverStats.chronologicalBacktracks ++;
+                }
+            }
             backtrack(topTrailIndex);
 
             // Asserting a constraint might introduce a conflict on the top variable so let's check
@@ -145,7 +168,7 @@ void Solver::analyzeConflict() {
                     return;
                 }
                 // Since in conflict, we keep the result on one side
-                if (resultCoefficients.coefficients[conflictVariable] > 0) {
+                if (resultCoefficients[conflictVariable] > 0) {
                     // Lower bound
                     lowerBoundCoefficients.swap(resultCoefficients);
                     std::swap(resultConstant, cLower);
@@ -203,6 +226,12 @@ void Solver::analyzeConflict() {
                     case ConstraintTypeInteger:
                         d_state.printConstraint<ConstraintTypeInteger>(d_cm.get<ConstraintTypeInteger>(conflictConstraint), cout, OutputFormatIlp);
                         break;
+                    case ConstraintTypeInteger64:
+                        d_state.printConstraint<ConstraintTypeInteger64>(d_cm.get<ConstraintTypeInteger64>(conflictConstraint), cout, OutputFormatIlp);
+                        break;
+                    case ConstraintTypePseudoBoolean:
+                        d_state.printConstraint<ConstraintTypePseudoBoolean>(d_cm.get<ConstraintTypePseudoBoolean>(conflictConstraint), cout, OutputFormatIlp);
+                        break;
                     default:
                         assert(false);
                 }
@@ -210,31 +239,421 @@ void Solver::analyzeConflict() {
             }
         }
 
-        // Also, go though the caches constraints and assert any unit constraints
-        std::map<prop_variable_tag, tight_cache_element>::const_iterator t_it = d_tightConstraintCache.begin();
-        std::map<prop_variable_tag, tight_cache_element>::const_iterator t_it_end = d_tightConstraintCache.end();
-        for (; t_it != t_it_end; ++ t_it) {
-            const constraint_coefficient_map& coefficients = t_it->second.coefficients;
-            Integer rhs = t_it->second.constant;
-            if (coefficients.coefficients.size() == 1) {
-                Variable var = coefficients.coefficients.begin()->first;
-                Integer coefficient = coefficients.coefficients.begin()->second;
-                if (coefficient > 0) {
-                    // Lower bound
-                    Integer bound = NumberUtils<Integer>::divideUp(rhs, coefficient);
-                    if (!d_state.hasLowerBound(var) || bound > d_state.getLowerBound<TypeInteger>(var)) {
-                        assertTightConstraint(coefficients, rhs);
-                    }
-                } else {
-                    // Upper bound
-                    Integer bound = NumberUtils<Integer>::divideDown(rhs, coefficient);
-                    if (!d_state.hasUpperBound(var) || bound < d_state.getUpperBound<TypeInteger>(var)) {
-                        assertTightConstraint(coefficients, rhs);
-                    }
+        // Also, go though the cached unit constraints and assert the ones that improve a bound
+        for (unsigned i = 0; i < d_tightConstraintCacheUnits.size(); ) {
+            tight_cache::const_iterator find = d_tightConstraintCache.find(d_tightConstraintCacheUnits[i]);
+            if (find == d_tightConstraintCache.end() || find->second.coefficients.coefficients.size() != 1) {
+                // Invalidated on backtrack or replaced, forget it
+                d_tightConstraintCacheUnits[i] = d_tightConstraintCacheUnits.back();
+                d_tightConstraintCacheUnits.pop_back();
+                continue;
+            }
+            const constraint_coefficient_map& coefficients = find->second.coefficients;
+            Integer rhs = find->second.constant;
+            Variable var = coefficients.coefficients.begin()->first;
+            Integer coefficient = coefficients.coefficients.begin()->second;
+            if (coefficient > 0) {
+                // Lower bound
+                Integer bound = NumberUtils<Integer>::divideUp(rhs, coefficient);
+                if (!d_state.hasLowerBound(var) || bound > d_state.getLowerBound<TypeInteger>(var)) {
+                    assertTightConstraint(coefficients, rhs);
+                }
+            } else {
+                // Upper bound
+                Integer bound = NumberUtils<Integer>::divideDown(rhs, coefficient);
+                if (!d_state.hasUpperBound(var) || bound < d_state.getUpperBound<TypeInteger>(var)) {
+                    assertTightConstraint(coefficients, rhs);
                 }
             }
+            ++ i;
+        }
+    }
+}
+
+void Solver::cacheTightConstraint(const prop_variable_tag& tag, const constraint_coefficient_map& coefficients, const Integer& constant) {
+
+    // If full, make room, the evicted entries of the current conflict will be recomputed if needed
+    if (d_tightConstraintCache.size() >= s_tightConstraintCacheLimit) {
+        evictTightConstraintCache();
+    }
+
+    std::pair<tight_cache::iterator, bool> insert = d_tightConstraintCache.insert(tight_cache::value_type(tag, tight_cache_element()));
+    bool wasUnit = !insert.second && insert.first->second.coefficients.coefficients.size() == 1;
+    insert.first->second.coefficients = coefficients;
+    insert.first->second.constant = constant;
+
+    if (insert.second) {
+        d_tightConstraintCacheTrail.push(tag);
+    }
+    if (coefficients.coefficients.size() == 1 && !wasUnit) {
+        d_tightConstraintCacheUnits.push_back(tag);
+    }
+}
+
+void Solver::cancelTightConstraintCache(int trailIndex) {
+    while (!d_tightConstraintCacheTrail.empty() && (int) d_tightConstraintCacheTrail.top().lastModificationTime > trailIndex) {
+        d_tightConstraintCache.erase(d_tightConstraintCacheTrail.top());
+        d_tightConstraintCacheTrail.pop();
+    }
+}
+
+void Solver::evictTightConstraintCache() {
+
+    // Get the keys out of the queue, oldest first
+    std::vector<prop_variable_tag> keys;
+    keys.reserve(d_tightConstraintCacheTrail.size());
+    while (!d_tightConstraintCacheTrail.empty()) {
+        keys.push_back(d_tightConstraintCacheTrail.top());
+        d_tightConstraintCacheTrail.pop();
+    }
+    std::reverse(keys.begin(), keys.end());
+
+    // Evict the oldest entries down to half the limit, the units only if there are not enough other ones
+    unsigned target = s_tightConstraintCacheLimit / 2;
+    for (unsigned pass = 0; pass < 2 && d_tightConstraintCache.size() > target; ++ pass) {
+        std::vector<prop_variable_tag> kept;
+        kept.reserve(keys.size());
+        for (unsigned i = 0; i < keys.size(); ++ i) {
+            tight_cache::iterator find = d_tightConstraintCache.find(keys[i]);
+            assert(find != d_tightConstraintCache.end());
+            bool unit = find->second.coefficients.coefficients.size() == 1;
+            if (d_tightConstraintCache.size() > target && (pass > 0 || !unit)) {
+                // Evicted units are dropped from the unit list when it's next traversed
+                d_tightConstraintCache.erase(find);
+            } else {
+                kept.push_back(keys[i]);
+            }
+        }
+        keys.swap(kept);
+    }
+
+    d_tightConstraintCacheTrail = std::priority_queue<prop_variable_tag>(std::less<prop_variable_tag>(), keys);
+}
+
+ConstraintRef Solver::getClausalReason(Variable var, VariableModificationType type) const {
+    ConstraintRef reason;
+    if (type == MODIFICATION_LOWER_BOUND_REFINE) {
+        reason = d_state.getLowerBoundConstraint(var);
+    } else {
+        reason = d_state.getUpperBoundConstraint(var);
+    }
+    if (reason == ConstraintManager::NullConstraint) {
+        return reason;
+    }
+    switch (ConstraintManager::getType(reason)) {
+    case ConstraintTypeClause:
+    case ConstraintTypeBinaryClause:
+        return reason;
+    default:
+        return ConstraintManager::NullConstraint;
+    }
+}
+
+int Solver::getFalsifyingTrailIndex(const ClauseConstraintLiteral& literal) const {
+    Variable var = literal.getVariable();
+    if (literal.isNegated()) {
+        return d_state.getLowerBound<TypeInteger>(var) > 0 ? d_state.getLowerBoundTrailIndex(var) : -1;
+    } else {
+        return d_state.getUpperBound<TypeInteger>(var) < 1 ? d_state.getUpperBoundTrailIndex(var) : -1;
+    }
+}
+
+template<typename Clause>
+bool Solver::addClausalReason(const Clause& clause, Variable skip, unsigned conflictLevel, unsigned& pathCount) {
+
+    const SearchTrail& trail = d_state.getTrail();
+
+    for (unsigned i = 0, i_end = clause.getSize(); i < i_end; ++ i) {
+        const ClauseConstraintLiteral& literal = clause.getLiteral(i);
+        Variable var = literal.getVariable();
+        if (var == skip || d_clausalSeen[var.getId()]) {
+            continue;
+        }
+
+        // Get the bound that falsifies the literal
+        int trailIndex = getFalsifyingTrailIndex(literal);
+        if (trailIndex < 0) {
+            return false;
+        }
+
+        d_clausalSeen[var.getId()] = getFalsifyingType(literal) + 1;
+        d_clausalSeenVariables.push_back(var);
+
+        // Literals false at level 0 are dropped
+        unsigned level = trail.getLevelOfTrailIndex(trailIndex);
+        if (level == conflictLevel) {
+            pathCount ++;
+        } else if (level > 0) {
+            d_clausalLearnt.push_back(literal);
+        }
+    }
+
+    return true;
+}
+
+namespace {
+
+/** Literals of a clause in a vector, with the same interface as the clause */
+struct ClauseLiteralVector {
+    const std::vector<ClauseConstraintLiteral>& literals;
+    ClauseLiteralVector(const std::vector<ClauseConstraintLiteral>& literals)
+    : literals(literals) {}
+    size_t getSize() const {
+        return literals.size();
+    }
+    const ClauseConstraintLiteral& getLiteral(size_t i) const {
+        return literals[i];
+    }
+};
+
+}
+
+bool Solver::analyzeConflictClausal() {
+
+    CUTSAT_TRACE_FN("solver");
+
+    const SearchTrail& trail = d_state.getTrail();
+
+    // The conflicting bound is the last one on the trail, its reason has all literals false
+    unsigned trailIndex = trail.getSize() - 1;
+    assert(trail.getVariableModifiedAt(trailIndex) == d_state.getConflictVariable());
+    ConstraintRef conflictRef = getClausalReason(trail.getVariableModifiedAt(trailIndex), trail.getModificationTypeAt(trailIndex));
+    if (conflictRef == ConstraintManager::NullConstraint) {
+        return false;
+    }
+
+    if (d_clausalSeen.size() < d_state.getVariablesCount()) {
+        d_clausalSeen.resize(d_state.getVariablesCount(), 0);
+    }
+    d_clausalLearnt.clear();
+    d_clausalLearnt.push_back(ClauseConstraintLiteral());
+
+    // The conflict level is the top level of the conflict literals
+    unsigned conflictLevel = 0;
+    std::vector<ClauseConstraintLiteral> conflictLiterals;
+    if (ConstraintManager::isBinaryClause(conflictRef)) {
+        const BinaryClause& clause = d_cm.getBinaryClause(conflictRef);
+        conflictLiterals.push_back(clause.getLiteral(0));
+        conflictLiterals.push_back(clause.getLiteral(1));
+    } else {
+        const ClauseConstraint& clause = d_cm.get<ConstraintTypeClause>(conflictRef);
+        for (unsigned i = 0, i_end = clause.getSize(); i < i_end; ++ i) {
+            conflictLiterals.push_back(clause.getLiteral(i));
+        }
+    }
+    for (unsigned i = 0; i < conflictLiterals.size(); ++ i) {
+        int literalIndex = getFalsifyingTrailIndex(conflictLiterals[i]);
+        if (literalIndex < 0) {
+            return false;
+        }
+        unsigned level = trail.getLevelOfTrailIndex(literalIndex);
+        if (level > conflictLevel) {
+            conflictLevel = level;
+        }
+    }
+
+    // Resolve the reasons of the bounds at the conflict level, latest first, until only one is left
+    std::vector<ConstraintRef> reasons;
+    if (!ConstraintManager::isBinaryClause(conflictRef)) {
+        reasons.push_back(conflictRef);
+    }
+    unsigned pathCount = 0;
+    bool ok = conflictLevel > 0 && addClausalReason(ClauseLiteralVector(conflictLiterals), VariableNull, conflictLevel, pathCount);
+    Variable uip = VariableNull;
+    while (ok) {
+        // Next seen bound on the trail
+        Variable var = trail.getVariableModifiedAt(trailIndex);
+        VariableModificationType type = trail.getModificationTypeAt(trailIndex);
+        while (d_clausalSeen[var.getId()] != type + 1) {
+            -- trailIndex;
+            var = trail.getVariableModifiedAt(trailIndex);
+            type = trail.getModificationTypeAt(trailIndex);
+        }
+        // The last one is the UIP
+        if (-- pathCount == 0) {
+            uip = var;
+            d_clausalLearnt[0] = ClauseConstraintLiteral(var, type == MODIFICATION_LOWER_BOUND_REFINE);
+            break;
+        }
+        // Otherwise resolve with the reason
+        ConstraintRef reasonRef = getClausalReason(var, type);
+        if (reasonRef == ConstraintManager::NullConstraint) {
+            ok = false;
+        } else if (ConstraintManager::isBinaryClause(reasonRef)) {
+            ok = addClausalReason(d_cm.getBinaryClause(reasonRef), var, conflictLevel, pathCount);
+        } else {
+            reasons.push_back(reasonRef);
+            ok = addClausalReason(d_cm.get<ConstraintTypeClause>(reasonRef), var, conflictLevel, pathCount);
+        }
+        -- trailIndex;
+    }
+
+    // Clear the seen flags
+    for (unsigned i = 0; i < d_clausalSeenVariables.size(); ++ i) {
+        d_clausalSeen[d_clausalSeenVariables[i].getId()] = 0;
+    }
+
+    if (!ok) {
+        d_clausalSeenVariables.clear();
+        // Conflict at level 0 is final
+        if (conflictLevel == 0) {
+            d_status = Unsatisfiable;
+            return true;
+        }
+        return false;
+    }
+
+    d_solverStats.clausalConflicts ++;
+    d_solverStats.conflictsInAnalysis ++;
+
+    // Bump the variables and constraints
+    for (unsigned i = 0; i < d_clausalSeenVariables.size(); ++ i) {
+        d_state.bumpVariable(d_clausalSeenVariables[i], 1);
+    }
+    d_clausalSeenVariables.clear();
+    for (unsigned i = 0; i < reasons.size(); ++ i) {
+        bumpConstraint(reasons[i]);
+    }
+
+    // Remove the literals implied by the rest, except the UIP
+    minimizeClause(d_clausalLearnt, 1);
+
+    // Backtrack to the top level of the rest of the clause, where the UIP will propagate
+    unsigned backtrackLevel = 0;
+    for (unsigned i = 1; i < d_clausalLearnt.size(); ++ i) {
+        unsigned level = trail.getLevelOfTrailIndex(getFalsifyingTrailIndex(d_clausalLearnt[i]));
+        if (level > backtrackLevel) {
+            backtrackLevel = level;
+        }
+    }
+    unsigned level = trail.getDecisionLevel();
+    if (d_chronologicalBacktrackLevels > 0 && conflictLevel == level && level - backtrackLevel > d_chronologicalBacktrackLevels) {
+        backtrackLevel = level - 1;
+        d_solverStats.chronologicalBacktracks ++;
+    }
+    backtrack(trail.getTrailIndexOfLevel(backtrackLevel));
+
+    // Assert the learned clause
+    d_propagators.setPropagatingInfo(uip);
+    ConstraintRef learntRef = assertClauseConstraint(d_clausalLearnt, CONSTRAINT_CLASS_EXPLANATION);
+    if (learntRef != ConstraintManager::NullConstraint) {
+        bumpConstraint(learntRef);
+        if (d_verbosity >= VERBOSITY_DETAILED) {
+            cout << "Learned clause: ";
+            d_state.printConstraint<ConstraintTypeClause>(d_cm.get<ConstraintTypeClause>(learntRef), cout, OutputFormatIlp);
+            cout << std::endl;
+        }
+    }
+
+    return true;
+}
+
+template<typename Clause>
+bool Solver::addRedundantReason(const Clause& clause, Variable skip, unsigned abstractLevels) {
+
+    const SearchTrail& trail = d_state.getTrail();
+
+    for (unsigned i = 0, i_end = clause.getSize(); i < i_end; ++ i) {
+        const ClauseConstraintLiteral& literal = clause.getLiteral(i);
+        Variable var = literal.getVariable();
+        if (var == skip || d_clausalSeen[var.getId()]) {
+            continue;
+        }
+        int trailIndex = getFalsifyingTrailIndex(literal);
+        if (trailIndex < 0) {
+            return false;
+        }
+        unsigned level = trail.getLevelOfTrailIndex(trailIndex);
+        if (level == 0) {
+            continue;
+        }
+        // Can only be implied by the clause literals if there is a literal at the same level
+        if ((abstractLevels & getAbstractLevel(level)) == 0) {
+            return false;
+        }
+        if (getClausalReason(var, getFalsifyingType(literal)) == ConstraintManager::NullConstraint) {
+            return false;
+        }
+        d_clausalSeen[var.getId()] = getFalsifyingType(literal) + 1;
+        d_clausalSeenVariables.push_back(var);
+        d_minimizationStack.push_back(literal);
+    }
+
+    return true;
+}
+
+bool Solver::isRedundant(const ClauseConstraintLiteral& literal, unsigned abstractLevels) {
+
+    unsigned seenSize = d_clausalSeenVariables.size();
+
+    d_minimizationStack.clear();
+    d_minimizationStack.push_back(literal);
+
+    while (!d_minimizationStack.empty()) {
+        ClauseConstraintLiteral current = d_minimizationStack.back();
+        d_minimizationStack.pop_back();
+
+        Variable var = current.getVariable();
+        ConstraintRef reasonRef = getClausalReason(var, getFalsifyingType(current));
+        bool redundant;
+        if (reasonRef == ConstraintManager::NullConstraint) {
+            redundant = false;
+        } else if (ConstraintManager::isBinaryClause(reasonRef)) {
+            redundant = addRedundantReason(d_cm.getBinaryClause(reasonRef), var, abstractLevels);
+        } else {
+            redundant = addRedundantReason(d_cm.get<ConstraintTypeClause>(reasonRef), var, abstractLevels);
+        }
+
+        if (!redundant) {
+            // Undo the marks of this search, the ones before are still known to be implied
+            for (unsigned i = seenSize; i < d_clausalSeenVariables.size(); ++ i) {
+                d_clausalSeen[d_clausalSeenVariables[i].getId()] = 0;
+            }
+            d_clausalSeenVariables.resize(seenSize);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Solver::minimizeClause(std::vector<ClauseConstraintLiteral>& literals, unsigned keep) {
+
+    CUTSAT_TRACE_FN("solver") << literals << std::endl;
+
+    const SearchTrail& trail = d_state.getTrail();
+
+    if (d_clausalSeen.size() < d_state.getVariablesCount()) {
+        d_clausalSeen.resize(d_state.getVariablesCount(), 0);
+    }
+
+    // Mark the literals and collect their levels
+    unsigned abstractLevels = 0;
+    for (unsigned i = 0; i < literals.size(); ++ i) {
+        Variable var = literals[i].getVariable();
+        d_clausalSeen[var.getId()] = getFalsifyingType(literals[i]) + 1;
+        d_clausalSeenVariables.push_back(var);
+        int trailIndex = getFalsifyingTrailIndex(literals[i]);
+        if (trailIndex >= 0) {
+            abstractLevels |= getAbstractLevel(trail.getLevelOfTrailIndex(trailIndex));
         }
     }
+
+    // Remove the false literals implied by the others
+    unsigned kept = keep;
+    for (unsigned i = keep; i < literals.size(); ++ i) {
+        if (getFalsifyingTrailIndex(literals[i]) < 0 || !isRedundant(literals[i], abstractLevels)) {
+            literals[kept ++] = literals[i];
+        }
+    }
+    d_solverStats.minimizedLiterals += literals.size() - kept;
+    literals.resize(kept);
+
+    // Clear the marks
+    for (unsigned i = 0; i < d_clausalSeenVariables.size(); ++ i) {
+        d_clausalSeen[d_clausalSeenVariables[i].getId()] = 0;
+    }
+    d_clausalSeenVariables.clear();
 }
 
 ConstraintRef Solver::assertTightConstraint(const constraint_coefficient_map& coefficients, Integer& constant) {
@@ -275,6 +694,10 @@ ConstraintRef Solver::assertTightConstraint(const constraint_coefficient_map& co
     	  assert(isBoolean(it->first));
     	  literals.push_back(ClauseConstraintLiteral(it->first, it->second < 0));
     	}
+    	// The clause is asserting, so at least one literal is not false and stays
+    	if (literals.size() > 1) {
+    	  minimizeClause(literals, 0);
+    	}
     	return assertClauseConstraint(literals, CONSTRAINT_CLASS_EXPLANATION);
     }
     default:
@@ -297,17 +720,14 @@ void Solver::getTighltyPropagatingConstraint(Variable x, unsigned trailIndex, co
     // Constraint is tight if coefficient with x is 1
     if (xCoefficientAbs == 1) {
         // Cache the result
-        prop_variable_tag cache_tag(x, trailIndex, type);
-        d_tightConstraintCache[cache_tag].coefficients = outCoefficients;
-        d_tightConstraintCache[cache_tag].constant = outConstant;
+        cacheTightConstraint(prop_variable_tag(x, trailIndex, type), outCoefficients, outConstant);
         return;
     }
 
     // Check if it's in the cache already (unless we are dealing with the resolvent)
     if (!replace) {
-        constraint_coefficient_map tightCoefficients;
         prop_variable_tag var_tag(x, trailIndex, type);
-        std::map<prop_variable_tag, tight_cache_element>::const_iterator find = d_tightConstraintCache.find(var_tag);
+        tight_cache::const_iterator find = d_tightConstraintCache.find(var_tag);
         if (find != d_tightConstraintCache.end()) {
             // In cache
             outCoefficients = find->second.coefficients;
@@ -316,60 +736,69 @@ void Solver::getTighltyPropagatingConstraint(Variable x, unsigned trailIndex, co
         }
     }
 
-    std::map<prop_variable_tag, Integer> coefficients;
-    std::set<prop_variable_tag> inQueue;
+    // The bounds in the derivation with their coefficients, the bound of x comes first and is not eliminated
+    std::vector<tight_term> terms;
+    // Positions of the terms we overwrote in the shared index, restored when done
+    std::vector<std::pair<unsigned, unsigned> > overwrittenPositions;
+    // The terms to eliminate, latest bound first
+    RadixHeap<unsigned> queue(trailIndex);
 
-    typedef __gnu_pbds::priority_queue<prop_variable_tag> var_queue;
-    var_queue queue;
+    if (d_tightTermPositions.size() <= trailIndex) {
+        d_tightTermPositions.resize(trailIndex + 1);
+    }
 
     // Construct the initial coefficients of the propagating constraint
     constraint_coefficient_map::const_iterator it = outCoefficients.begin();
     constraint_coefficient_map::const_iterator it_end = outCoefficients.end();
+    terms.push_back(tight_term(prop_variable_tag(x, trailIndex, MODIFICATION_COUNT), outCoefficients[x]));
     for(; it != it_end; ++ it) {
         Variable variable = it->first;
+        if (variable == x) {
+            continue;
+        }
         VariableModificationType modType = MODIFICATION_COUNT;
         unsigned propIndex = trailIndex;
-        if (variable != x) {
-            switch(d_state.getValueStatus(variable, trailIndex)) {
-                case ValueStatusAssignedToLower:
-                    propIndex = d_state.getLowerBoundTrailIndex(variable, trailIndex);
-                    modType = MODIFICATION_LOWER_BOUND_REFINE;
-                    break;
-                case ValueStatusAssignedToUpper:
+        switch(d_state.getValueStatus(variable, trailIndex)) {
+            case ValueStatusAssignedToLower:
+                propIndex = d_state.getLowerBoundTrailIndex(variable, trailIndex);
+                modType = MODIFICATION_LOWER_BOUND_REFINE;
+                break;
+            case ValueStatusAssignedToUpper:
+                propIndex = d_state.getUpperBoundTrailIndex(variable, trailIndex);
+                modType = MODIFICATION_UPPER_BOUND_REFINE;
+                break;
+            default:
+                if (it->second > 0) {
+                    // Upper bound
                     propIndex = d_state.getUpperBoundTrailIndex(variable, trailIndex);
                     modType = MODIFICATION_UPPER_BOUND_REFINE;
-                    break;
-                default:
-                    if (it->second > 0) {
-                        // Upper bound
-                        propIndex = d_state.getUpperBoundTrailIndex(variable, trailIndex);
-                        modType = MODIFICATION_UPPER_BOUND_REFINE;
-                    } else {
-                        // Lower bound
-                        propIndex = d_state.getLowerBoundTrailIndex(variable, trailIndex);
-                        modType = MODIFICATION_LOWER_BOUND_REFINE;
-                    }
-            }
-        }
-        prop_variable_tag var_tag(variable, propIndex, modType);
-        if (variable != x) {
-            CUTSAT_TRACE("solver") << "Adding " << variable << " with time " << propIndex << std::endl;
-            queue.push(var_tag);
-            inQueue.insert(var_tag);
-        }
-        coefficients[var_tag] = it->second;
+                } else {
+                    // Lower bound
+                    propIndex = d_state.getLowerBoundTrailIndex(variable, trailIndex);
+                    modType = MODIFICATION_LOWER_BOUND_REFINE;
+                }
+        }
+        CUTSAT_TRACE("solver") << "Adding " << variable << " with time " << propIndex << std::endl;
+        getTightTerm(prop_variable_tag(variable, propIndex, modType), terms, overwrittenPositions, queue) += it->second;
     }
     // Clear the output
     outCoefficients.clear();
 
+    // The tight constraints of the eliminated variables, in the map of this nesting level
+    if (d_tightCoefficients.size() <= d_tightDerivationDepth) {
+        d_tightCoefficients.push_back(constraint_coefficient_map());
+    }
+    constraint_coefficient_map& tightCoefficients = d_tightCoefficients[d_tightDerivationDepth ++];
+    Integer tightRHS;
+
     // Constraint is not tight, so we setup the queue for the variables
     while (!queue.empty()) {
         // Get the variable
-        prop_variable_tag var_tag = queue.top();
+        unsigned termPosition = queue.top();
         queue.pop();
-        inQueue.erase(var_tag);
+        prop_variable_tag var_tag = terms[termPosition].tag;
         Variable variable = var_tag.variable;
-        Integer variableCoefficient = coefficients[var_tag];
+        Integer variableCoefficient = terms[termPosition].coefficient;
         unsigned variableIndex = var_tag.lastModificationTime;
 
         CUTSAT_TRACE("solver") << "Eliminating " << variable << " with coefficient " << variableCoefficient << " at time " << variableIndex << std::endl;
@@ -380,9 +809,7 @@ void Solver::getTighltyPropagatingConstraint(Variable x, unsigned trailIndex, co
         }
 
         // Otherwise get the propagating constraint for this one
-        constraint_coefficient_map tightCoefficients;
-        Integer tightRHS;
-        std::map<prop_variable_tag, tight_cache_element>::const_iterator find = d_tightConstraintCache.find(var_tag);
+        tight_cache::const_iterator find = d_tightConstraintCache.find(var_tag);
         if (find == d_tightConstraintCache.end()) {
             // Not in cache
             switch (var_tag.type) {
@@ -426,40 +853,33 @@ void Solver::getTighltyPropagatingConstraint(Variable x, unsigned trailIndex, co
         constraint_coefficient_map::const_iterator it_end = tightCoefficients.end();
         for(; it != it_end; ++ it) {
             Variable tightVariable = it->first;
+            if (tightVariable == variable) {
+                terms[termPosition].coefficient += it->second * multiplier;
+                continue;
+            }
             unsigned propIndex = variableIndex;
             VariableModificationType modType = MODIFICATION_COUNT;
-            if (tightVariable != variable) {
-                switch(d_state.getValueStatus(tightVariable, variableIndex)) {
-                case ValueStatusAssignedToLower:
-                    propIndex = d_state.getLowerBoundTrailIndex(tightVariable, variableIndex);
-                    modType = MODIFICATION_LOWER_BOUND_REFINE;
-                    break;
-                case ValueStatusAssignedToUpper:
+            switch(d_state.getValueStatus(tightVariable, variableIndex)) {
+            case ValueStatusAssignedToLower:
+                propIndex = d_state.getLowerBoundTrailIndex(tightVariable, variableIndex);
+                modType = MODIFICATION_LOWER_BOUND_REFINE;
+                break;
+            case ValueStatusAssignedToUpper:
+                propIndex = d_state.getUpperBoundTrailIndex(tightVariable, variableIndex);
+                modType = MODIFICATION_UPPER_BOUND_REFINE;
+                break;
+            default:
+                if (it->second > 0) {
+                    // Upper bound
                     propIndex = d_state.getUpperBoundTrailIndex(tightVariable, variableIndex);
                     modType = MODIFICATION_UPPER_BOUND_REFINE;
-                    break;
-                default:
-                    if (it->second > 0) {
-                        // Upper bound
-                        propIndex = d_state.getUpperBoundTrailIndex(tightVariable, variableIndex);
-                        modType = MODIFICATION_UPPER_BOUND_REFINE;
-                    } else {
-                        // Lower bound
-                        propIndex = d_state.getLowerBoundTrailIndex(tightVariable, variableIndex);
-                        modType = MODIFICATION_LOWER_BOUND_REFINE;
-                    }
-                }
-            }
-            if (tightVariable != variable) {
-                prop_variable_tag tight_var_tag(tightVariable, propIndex, modType);
-                if (inQueue.find(tight_var_tag) == inQueue.end()) {
-                    inQueue.insert(tight_var_tag);
-                    queue.push(tight_var_tag);
+                } else {
+                    // Lower bound
+                    propIndex = d_state.getLowerBoundTrailIndex(tightVariable, variableIndex);
+                    modType = MODIFICATION_LOWER_BOUND_REFINE;
                 }
-                coefficients[tight_var_tag] += tightCoefficients[tightVariable] * multiplier;
-            } else {
-                coefficients[var_tag] += tightCoefficients[tightVariable] * multiplier;
             }
+            getTightTerm(prop_variable_tag(tightVariable, propIndex, modType), terms, overwrittenPositions, queue) += it->second * multiplier;
         }
 
         // Also add to the RHS
@@ -468,12 +888,17 @@ void Solver::getTighltyPropagatingConstraint(Variable x, unsigned trailIndex, co
         CUTSAT_TRACE("solver") << "RHS" << outConstant << std::endl;
     }
 
+    -- d_tightDerivationDepth;
+
+    // Give the index back to the caller
+    for (unsigned i = overwrittenPositions.size(); i > 0; -- i) {
+        d_tightTermPositions[overwrittenPositions[i-1].first] = overwrittenPositions[i-1].second;
+    }
+
     // Move the coefficients into the output (all divisible by xCoefficient)
-    std::map<prop_variable_tag, Integer>::const_iterator out_it = coefficients.begin();
-    std::map<prop_variable_tag, Integer>::const_iterator out_it_end = coefficients.end();
-    for(; out_it != out_it_end; ++ out_it) {
-        Variable variable = out_it->first.variable;
-        const Integer& coefficient = out_it->second;
+    for (unsigned i = 0; i < terms.size(); ++ i) {
+        Variable variable = terms[i].tag.variable;
+        const Integer& coefficient = terms[i].coefficient;
         if (coefficient != 0) {
             assert(NumberUtils<Integer>::divides(xCoefficientAbs, coefficient));
             outCoefficients[variable] += NumberUtils<Integer>::divideUp(coefficient, xCoefficientAbs);
@@ -484,9 +909,23 @@ void Solver::getTighltyPropagatingConstraint(Variable x, unsigned trailIndex, co
     outConstant = NumberUtils<Integer>::divideUp(outConstant, xCoefficientAbs);
 
     // Cache the result
-    prop_variable_tag cache_tag(x, trailIndex, type);
-    d_tightConstraintCache[cache_tag].coefficients = outCoefficients;
-    d_tightConstraintCache[cache_tag].constant = outConstant;
+    cacheTightConstraint(prop_variable_tag(x, trailIndex, type), outCoefficients, outConstant);
+}
+
+Integer& Solver::getTightTerm(const prop_variable_tag& tag, std::vector<tight_term>& terms,
+        std::vector<std::pair<unsigned, unsigned> >& overwrittenPositions, RadixHeap<unsigned>& queue) {
+    unsigned trailIndex = tag.lastModificationTime;
+    unsigned position = d_tightTermPositions[trailIndex];
+    if (position < terms.size() && terms[position].tag == tag) {
+        return terms[position].coefficient;
+    }
+    // New term, remember what was in the index (a derivation we're called from might be using it)
+    overwrittenPositions.push_back(std::make_pair(trailIndex, position));
+    position = terms.size();
+    d_tightTermPositions[trailIndex] = position;
+    terms.push_back(tight_term(tag, 0));
+    queue.push(trailIndex, position);
+    return terms.back().coefficient;
 }
 
 Variable Solver::getTopVariable(ConstraintRef constraintRef) {
@@ -498,9 +937,39 @@ Variable Solver::getTopVariable(ConstraintRef constraintRef) {
     if (ConstraintManager::getType(constraintRef) == ConstraintTypeInteger) {
         const IntegerConstraint& constraint = d_cm.get<ConstraintTypeInteger>(constraintRef);
         CUTSAT_TRACE_FN("solver") << constraint;
+        const IntegerConstraint::literal_storage literals = constraint.getLiterals();
         for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
-            const IntegerConstraintLiteral& literal = constraint.getLiteral(i);
-            Variable literalVariable = literal.getVariable();
+            Variable literalVariable = literals.getVariable(i);
+            int trailIndex = d_state.getLastModificationTrailIndex<true>(literalVariable);
+            if (trailIndex > topTrailIndex) {
+                topTrailIndex = trailIndex;
+                topVariable = literalVariable;
+            }
+        }
+    }
+
+    // Native integer constraints
+    if (ConstraintManager::getType(constraintRef) == ConstraintTypeInteger64) {
+        const Integer64Constraint& constraint = d_cm.get<ConstraintTypeInteger64>(constraintRef);
+        CUTSAT_TRACE_FN("solver") << constraint;
+        const Integer64Constraint::literal_storage literals = constraint.getLiterals();
+        for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+            Variable literalVariable = literals.getVariable(i);
+            int trailIndex = d_state.getLastModificationTrailIndex<true>(literalVariable);
+            if (trailIndex > topTrailIndex) {
+                topTrailIndex = trailIndex;
+                topVariable = literalVariable;
+            }
+        }
+    }
+
+    // Pseudo-Boolean constraints
+    if (ConstraintManager::getType(constraintRef) == ConstraintTypePseudoBoolean) {
+        const PseudoBooleanConstraint& constraint = d_cm.get<ConstraintTypePseudoBoolean>(constraintRef);
+        CUTSAT_TRACE_FN("solver") << constraint;
+        const PseudoBooleanConstraint::literal_storage literals = constraint.getLiterals();
+        for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+            Variable literalVariable = literals.getVariable(i);
             int trailIndex = d_state.getLastModificationTrailIndex<true>(literalVariable);
             if (trailIndex > topTrailIndex) {
                 topTrailIndex = trailIndex;
@@ -524,6 +993,20 @@ Variable Solver::getTopVariable(ConstraintRef constraintRef) {
         }
     }
 
+    // Binary clauses
+    if (ConstraintManager::getType(constraintRef) == ConstraintTypeBinaryClause) {
+        const BinaryClause& constraint = d_cm.getBinaryClause(constraintRef);
+        CUTSAT_TRACE_FN("solver") << constraint;
+        for(unsigned i = 0; i < 2; ++ i) {
+            Variable literalVariable = constraint.getLiteral(i).getVariable();
+            int trailIndex = d_state.getLastModificationTrailIndex<true>(literalVariable);
+            if (trailIndex > topTrailIndex) {
+                topTrailIndex = trailIndex;
+                topVariable = literalVariable;
+            }
+        }
+    }
+
     CUTSAT_TRACE_FN("solver") << "=> " << topVariable;
 
     return topVariable;
@@ -574,8 +1057,10 @@ void Solver::setUpConstraintMap(Variable var, unsigned trailIndex, VariableModif
         assert(false);
     }
 
-    // Bump the constraint (we are using it)
-    d_conflictConstraints.insert(propagatingConstraintRef);
+    // Bump the constraint (we are using it), binary clauses are problem constraints and have no score
+    if (!ConstraintManager::isBinaryClause(propagatingConstraintRef)) {
+        d_conflictConstraints.insert(propagatingConstraintRef);
+    }
 
     // If not unit, get the constraint and setup the map
     coefficients.constraintType = ConstraintManager::getType(propagatingConstraintRef);
@@ -591,11 +1076,24 @@ void Solver::setUpConstraintMap(Variable var, unsigned trailIndex, VariableModif
             constant = constraint.getConstant();
             break;
         }
+    case ConstraintTypeBinaryClause: {
+            // The map is resolved as any other clause
+            coefficients.constraintType = ConstraintTypeClause;
+            const BinaryClause& constraint = d_cm.getBinaryClause(propagatingConstraintRef);
+            for(unsigned i = 0; i < 2; ++ i) {
+                const ClauseConstraintLiteral& literal = constraint.getLiteral(i);
+                Variable literalVariable = literal.getVariable();
+                coefficients[literalVariable] = literal.getCoefficient();
+                d_conflictVariables[literalVariable] += bumpValue;
+            }
+            constant = constraint.getConstant();
+            break;
+        }
     case ConstraintTypeCardinality: {
-        const ClauseConstraint& constraint = d_cm.get<ConstraintTypeClause>(propagatingConstraintRef);
+        const CardinalityConstraint& constraint = d_cm.get<ConstraintTypeCardinality>(propagatingConstraintRef);
         int negativeCoefficients = 0;
         for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
-            const ClauseConstraintLiteral& literal = constraint.getLiteral(i);
+            const CardinalityConstraintLiteral& literal = constraint.getLiteral(i);
             Variable literalVariable = literal.getVariable();
             coefficients[literalVariable] = literal.getCoefficient();
             if (literal.getCoefficient() < 0) negativeCoefficients ++;
@@ -606,10 +1104,36 @@ void Solver::setUpConstraintMap(Variable var, unsigned trailIndex, VariableModif
     }
     case ConstraintTypeInteger: {
             const IntegerConstraint& constraint = d_cm.get<ConstraintTypeInteger>(propagatingConstraintRef);
+            const IntegerConstraint::literal_storage literals = constraint.getLiterals();
             for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
-                const IntegerConstraintLiteral& literal = constraint.getLiteral(i);
-                Variable literalVariable = literal.getVariable();
-                coefficients[literalVariable] = literal.getCoefficient();
+                Variable literalVariable = literals.getVariable(i);
+                coefficients[literalVariable] = literals.getCoefficient(i);
+                d_conflictVariables[literalVariable] += bumpValue;
+            }
+            constant = constraint.getConstant();
+            break;
+        }
+    case ConstraintTypeInteger64: {
+            // The map is resolved as any other integer constraint
+            coefficients.constraintType = ConstraintTypeInteger;
+            const Integer64Constraint& constraint = d_cm.get<ConstraintTypeInteger64>(propagatingConstraintRef);
+            const Integer64Constraint::literal_storage literals = constraint.getLiterals();
+            for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+                Variable literalVariable = literals.getVariable(i);
+                coefficients[literalVariable] = literals.getCoefficient(i);
+                d_conflictVariables[literalVariable] += bumpValue;
+            }
+            constant = constraint.getConstant();
+            break;
+        }
+    case ConstraintTypePseudoBoolean: {
+            // The map is resolved as any other integer constraint
+            coefficients.constraintType = ConstraintTypeInteger;
+            const PseudoBooleanConstraint& constraint = d_cm.get<ConstraintTypePseudoBoolean>(propagatingConstraintRef);
+            const PseudoBooleanConstraint::literal_storage literals = constraint.getLiterals();
+            for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+                Variable literalVariable = literals.getVariable(i);
+                coefficients[literalVariable] = literals.getCoefficient(i);
                 d_conflictVariables[literalVariable] += bumpValue;
             }
             constant = constraint.getConstant();
@@ -634,11 +1158,9 @@ void Solver::resolveCoefficientMaps(Variable var,
     // We resolve them as usual -a2 I1 + a1 I2
 
     assert(lowerBoundCoefficients.find(var) != lowerBoundCoefficients.end());
-    assert(NumberUtils<Rational>::getDenominator(lowerBoundCoefficients.find(var)->second) == 1);
-    Integer aLower = NumberUtils<Rational>::getNumerator(lowerBoundCoefficients.find(var)->second);
+    Integer aLower = lowerBoundCoefficients.find(var)->second;
     assert(upperBoundCoefficients.find(var) != upperBoundCoefficients.end());
-    assert(NumberUtils<Rational>::getDenominator(upperBoundCoefficients.find(var)->second) == 1);
-    Integer aUpper = NumberUtils<Rational>::getNumerator(upperBoundCoefficients.find(var)->second);
+    Integer aUpper = upperBoundCoefficients.find(var)->second;
 
     bool boolean = true;
     bool bothConstraintsAreClauses =
@@ -38,11 +38,14 @@ Solver::Solver(ConstraintManager& cm)
 : d_cm(cm),
   d_restartHeuristic(d_solverStats),
   d_explanationRemovalHeuristic(d_solverStats),
+  d_explanationIndex(cm),
   d_constraintHeuristicIncrease(1),
   d_constraintHeuristicDecay(1.001),
   d_propagationTrailIndex(0),
+  d_expensivePropagationTrailIndex(0),
   d_status(Unknown),
   d_state(cm),
+  d_tightDerivationDepth(0),
   d_propagators(d_cm, d_state),
   d_checkModel(true),
   d_disablePropagation(false),
@@ -51,7 +54,8 @@ Solver::Solver(ConstraintManager& cm)
   d_boundEstimate(0),
   d_defaultBound(-1),
   d_replaceVarsWithSlacks(false),
-  d_tryFourierMotzkin(false)
+  d_tryFourierMotzkin(false),
+  d_chronologicalBacktrackLevels(0)
 {
 }
 
@@ -64,6 +68,11 @@ SolverStatus Solver::solve() {
     // Set the initial trail index
     d_initialTrailIndex = d_state.getTrailSize() - 1;
 
+    // Propagation while asserting might have found a conflict already (the rest was not asserted)
+    if (d_status == Unknown && d_state.inConflict()) {
+    	d_status = Unsatisfiable;
+    }
+
     // If we already have a state, return it
     if (d_status != Unknown) {
         return d_status;
@@ -98,6 +107,7 @@ SolverStatus Solver::solve() {
         d_solverStats.constraintManagerCapacity = d_cm.getCapacity();
         d_solverStats.constraintManagerSize = d_cm.getSize();
         d_solverStats.constraintManagerWasted = d_cm.getWasted();
+        d_solverStats.duplicateConstraints = d_explanationIndex.getDuplicates();
         // Print the stats as necessary
         if (d_verbosity >= VERBOSITY_BASIC_INFO) {
             cout << "--------------------------------------------------------------" << endl;
@@ -176,6 +186,7 @@ SolverStatus Solver::search() {
             // Restart if needed
             if (d_restartHeuristic.decide()) {
                 backtrack(d_state.getSafeIndex());
+                d_state.clearSavedTrail();
                 d_propagators.repropagate();
                 return Unknown;
             }
@@ -266,6 +277,18 @@ void Solver::attachConstraint(ConstraintRef constraintRef, ConstraintClass const
         d_solverStats.integerConstraints ++;
     	d_propagators.attachConstraint<ConstraintTypeInteger>(constraintRef);
     	break;
+    case ConstraintTypeInteger64:
+        d_solverStats.integerConstraints ++;
+    	d_propagators.attachConstraint<ConstraintTypeInteger64>(constraintRef);
+    	break;
+    case ConstraintTypePseudoBoolean:
+        d_solverStats.pseudoBooleanConstraints ++;
+    	d_propagators.attachConstraint<ConstraintTypePseudoBoolean>(constraintRef);
+    	break;
+    case ConstraintTypeBinaryClause:
+        d_solverStats.clauseConstraints ++;
+    	d_propagators.attachConstraint<ConstraintTypeClause>(constraintRef);
+    	break;
     default:
     	assert(false);
     }
@@ -313,8 +336,12 @@ ConstraintRef Solver::assertClauseConstraint(vector<ClauseConstraintLiteral>& li
     	switch (preprocess) {
         case PREPROCESS_OK:
             if (literals.size() > 1) {
-            	// Create the constraint
-                constraint = d_cm.newConstraint<ConstraintTypeClause>(literals, constant, constraintClass != CONSTRAINT_CLASS_PROBLEM);
+            	// Create the constraint, binary problem clauses are kept outside of the constraint memory
+                if (literals.size() == 2 && constraintClass == CONSTRAINT_CLASS_PROBLEM) {
+                    constraint = d_cm.newBinaryClause(literals[0], literals[1]);
+                } else {
+                    constraint = d_cm.newConstraint<ConstraintTypeClause>(literals, constant, constraintClass != CONSTRAINT_CLASS_PROBLEM);
+                }
                 // If we're outputting cuts, print the problem
                 if (d_outputCuts && constraintClass == CONSTRAINT_CLASS_EXPLANATION) {
                     stringstream filename;
@@ -423,9 +450,26 @@ ConstraintRef Solver::assertIntegerConstraint(vector<IntegerConstraintLiteral>&
 
         switch (preprocess) {
         case PREPROCESS_OK:
+            if (literals.size() > 1 && constraintClass == CONSTRAINT_CLASS_EXPLANATION) {
+                // Normalize the order, and if we already have this cut just propagate with it
+                std::sort(literals.begin(), literals.end());
+                constraint = d_explanationIndex.find(literals, c);
+                if (constraint != ConstraintManager::NullConstraint) {
+                    if (ConstraintManager::getType(constraint) == ConstraintTypeInteger) {
+                        d_propagators.repropagateConstraint<ConstraintTypeInteger>(constraint);
+                    } else {
+                        d_propagators.repropagateConstraint<ConstraintTypeInteger64>(constraint);
+                    }
+                    propagate();
+                    break;
+                }
+            }
             if (literals.size() > 1) {
             	// Create the constraint
                 constraint = d_cm.newConstraint<ConstraintTypeInteger>(literals, c, constraintClass != CONSTRAINT_CLASS_PROBLEM);
+                if (constraintClass == CONSTRAINT_CLASS_EXPLANATION) {
+                    d_explanationIndex.insert(constraint);
+                }
                 // If we're outputting cuts, print the problem
                 if (d_outputCuts && constraintClass == CONSTRAINT_CLASS_EXPLANATION) {
                     stringstream filename;
@@ -472,6 +516,58 @@ ConstraintRef Solver::assertIntegerConstraint(vector<IntegerConstraintLiteral>&
     return constraint;
 }
 
+ConstraintRef Solver::assertPseudoBooleanConstraint(vector<PseudoBooleanConstraintLiteral>& literals, Integer64& c, ConstraintClass constraintClass) {
+    CUTSAT_TRACE_FN("solver") << literals << "," << c << endl;
+
+    // With slacks the variables are not Boolean anymore
+    if (d_replaceVarsWithSlacks && constraintClass == CONSTRAINT_CLASS_PROBLEM) {
+    	vector<IntegerConstraintLiteral> integerLiterals;
+    	for (unsigned i = 0, i_end = literals.size(); i < i_end; ++ i) {
+    		integerLiterals.push_back(IntegerConstraintLiteral(literals[i].getCoefficient(), literals[i].getVariable()));
+    	}
+    	Integer integerConstant = c;
+    	return assertIntegerConstraint(integerLiterals, integerConstant, constraintClass);
+    }
+
+    ConstraintRef constraint = ConstraintManager::NullConstraint;
+
+    if (d_status == Unknown && !d_state.inConflict()) {
+
+        // Normalize the constraint (wrt to the current 0 level assignment)
+        PreprocessStatus preprocess = d_propagators.preprocess<ConstraintTypePseudoBoolean>(literals, c, d_state.getSafeIndex());
+
+        switch (preprocess) {
+        case PREPROCESS_OK:
+            if (literals.size() > 1) {
+            	// Create the constraint
+                constraint = d_cm.newConstraint<ConstraintTypePseudoBoolean>(literals, c, constraintClass != CONSTRAINT_CLASS_PROBLEM);
+                // Attach the constraint watchers
+                attachConstraint(constraint, constraintClass);
+            } else {
+            	// A single literal that is not a tautology fixes the variable
+            	assert(literals.size() == 1);
+            	Variable var = literals[0].getVariable();
+            	if (literals[0].getCoefficient() > 0) {
+            		setLowerBound<TypeInteger>(var, 1);
+            	} else {
+            		setUpperBound<TypeInteger>(var, 0);
+            	}
+            }
+            propagate();
+            break;
+        case PREPROCESS_TAUTOLOGY:
+        	break;
+        case PREPROCESS_INCONSISTENT:
+       		d_status = Unsatisfiable;
+            break;
+        default:
+            assert(false);
+        }
+    }
+
+    return constraint;
+}
+
 Variable Solver::newVariable(VariableType type, const char* varNameInput) {
 
     string varName = varNameInput;
@@ -543,27 +639,104 @@ void Solver::propagate()
     const SearchTrail& trail = d_state.getTrail();
 
     // Propagate until everything done, or a conflict has been found
-    for(; d_propagationTrailIndex < trail.getSize(); ++ d_propagationTrailIndex) {
+    while (true) {
+
+        // Restore the bounds the last backtrack undid, if they hold again
+        restoreSavedTrail();
+        if (d_state.inConflict()) {
+            return;
+        }
 
-        // Find the event
-        const TrailElement& event = trail[d_propagationTrailIndex];
+        // Run the cheap propagators to fixpoint
+        for(; d_propagationTrailIndex < trail.getSize(); ++ d_propagationTrailIndex) {
+            propagateEvent(trail[d_propagationTrailIndex], PropagatorCollection::s_cheapPropagators);
+            // If we have a conflict, setup the constraints for conflict analysis
+            if (d_state.inConflict()) {
+                return;
+            }
+        }
 
-        // Propagate
-        switch (event.modificationType) {
-        case MODIFICATION_LOWER_BOUND_REFINE:
-            d_propagators.propagateEvent<MODIFICATION_LOWER_BOUND_REFINE>(event.var);
-            break;
-        case MODIFICATION_UPPER_BOUND_REFINE:
-            d_propagators.propagateEvent<MODIFICATION_UPPER_BOUND_REFINE>(event.var);
+        // Done if the expensive ones are done too
+        if (d_expensivePropagationTrailIndex == trail.getSize()) {
             break;
-        default:
-            assert(false);
         }
 
-        // If we have a conflict, setup the constraints for conflict analysis
+        // Pass the next element to the expensive propagators, and go back to the cheap ones
+        propagateEvent(trail[d_expensivePropagationTrailIndex], PropagatorCollection::s_expensivePropagators);
         if (d_state.inConflict()) {
             return;
         }
+        ++ d_expensivePropagationTrailIndex;
+    }
+}
+
+void Solver::restoreSavedTrail() {
+
+    // Are all the bounds before the current one holding
+    bool holding = true;
+
+    while (d_state.hasSavedBounds() && !d_state.inConflict()) {
+        SolverState::saved_bound saved = d_state.getSavedBound();
+        // If it holds already, the bounds after it don't need it
+        if (saved.type == MODIFICATION_LOWER_BOUND_REFINE) {
+            if (d_state.hasLowerBound(saved.var) && d_state.getLowerBound<TypeInteger>(saved.var) >= saved.value) {
+                d_state.popSavedBound();
+                continue;
+            }
+        } else {
+            if (d_state.hasUpperBound(saved.var) && d_state.getUpperBound<TypeInteger>(saved.var) <= saved.value) {
+                d_state.popSavedBound();
+                continue;
+            }
+        }
+        // Decisions and unit bounds wait to be made again, unless the variable got the other value
+        if (saved.reason == ConstraintManager::NullConstraint) {
+            if (holding && !d_state.isAssigned(saved.var)) {
+                break;
+            }
+            holding = false;
+            d_state.popSavedBound();
+            continue;
+        }
+        d_state.popSavedBound();
+        // Removed constraints can't be used anymore
+        if (!ConstraintManager::isBinaryClause(saved.reason) && d_cm.get<ConstraintTypeClause>(saved.reason).isDeleted()) {
+            holding = false;
+            continue;
+        }
+        unsigned oldTrailSize = d_state.getTrailSize();
+        if (holding) {
+            CUTSAT_TRACE("solver") << "Restoring " << saved.type << ": " << saved.var << " to " << saved.value << std::endl;
+            if (saved.type == MODIFICATION_LOWER_BOUND_REFINE) {
+                d_state.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(saved.var, saved.value, saved.reason);
+            } else {
+                d_state.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(saved.var, saved.value, saved.reason);
+            }
+            // The reason might not be watching this level, so it has to be repropagated if this is undone
+            if (oldTrailSize < d_state.getTrailSize()) {
+                d_propagators.addPropagation(saved.reason, oldTrailSize);
+            }
+        } else {
+            // Integer constraints only propagate bounds that fix the variable, the rest is left to their propagator
+            ConstraintType reasonType = ConstraintManager::getType(saved.reason);
+            if (reasonType != ConstraintTypeInteger && reasonType != ConstraintTypeInteger64) {
+                d_propagators.repropagate(saved.reason, saved.var);
+            }
+        }
+        d_solverStats.restoredBounds += d_state.getTrailSize() - oldTrailSize;
+    }
+}
+
+void Solver::propagateEvent(const TrailElement& event, unsigned char propagators) {
+    switch (event.modificationType) {
+    case MODIFICATION_LOWER_BOUND_REFINE:
+        d_propagators.propagateEvent<MODIFICATION_LOWER_BOUND_REFINE>(event.var, propagators);
+        break;
+    case MODIFICATION_UPPER_BOUND_REFINE:
+        d_propagators.propagateEvent<MODIFICATION_UPPER_BOUND_REFINE>(event.var, propagators);
+        break;
+    default:
+        assert(false);
     }
 }
 
@@ -583,10 +756,10 @@ void Solver::backtrack(int backtrackIndex) {
 
   // Update the propagation index to the size of the trail
   d_propagationTrailIndex = std::min(d_propagationTrailIndex, (unsigned) d_state.getTrail().getSize());
+  d_expensivePropagationTrailIndex = std::min(d_expensivePropagationTrailIndex, (unsigned) d_state.getTrail().getSize());
 
   // Clean the tight constraint cache above this index
-  prop_variable_tag var_tag(VariableNull, backtrackIndex, MODIFICATION_COUNT);
-  d_tightConstraintCache.erase(d_tightConstraintCache.upper_bound(var_tag), d_tightConstraintCache.end());
+  cancelTightConstraintCache(backtrackIndex);
 
   // Backtrack the propagators
   d_propagators.cancelUntil(backtrackIndex);
@@ -614,6 +787,17 @@ void Solver::checkModel() {
 				}
 			}
 			break;
+		case ConstraintTypeBinaryClause:
+			if (!d_cm.getBinaryClause(constraint).isSatisfied(d_state)) {
+				ok = false;
+				CUTSAT_TRACE("solver") << "Unsat: " << d_cm.getBinaryClause(constraint) << std::endl;
+				if (d_verbosity >= VERBOSITY_BASIC_INFO) {
+					cout << "Constraint not satisfied: ";
+					printConstraint(d_cm.getBinaryClause(constraint), cout, OutputFormatIlp);
+					cout << std::endl;
+				}
+			}
+			break;
 		case ConstraintTypeCardinality:
 			if (!d_cm.get<ConstraintTypeCardinality>(constraint).isSatisfied(d_state)) {
 				ok = false;
@@ -636,6 +820,28 @@ void Solver::checkModel() {
 				}
 			}
 			break;
+		case ConstraintTypeInteger64:
+			if (!d_cm.get<ConstraintTypeInteger64>(constraint).isSatisfied(d_state)) {
+				ok = false;
+				CUTSAT_TRACE("solver") << "Unsat: " << d_cm.get<ConstraintTypeInteger64>(constraint) << std::endl;
+				if (d_verbosity >= VERBOSITY_BASIC_INFO) {
+					cout << "Constraint not satisfied: ";
+					printConstraint<ConstraintTypeInteger64>(d_cm.get<ConstraintTypeInteger64>(constraint), cout, OutputFormatIlp);
+					cout << std::endl;
+				}
+			}
+			break;
+		case ConstraintTypePseudoBoolean:
+			if (!d_cm.get<ConstraintTypePseudoBoolean>(constraint).isSatisfied(d_state)) {
+				ok = false;
+				CUTSAT_TRACE("solver") << "Unsat: " << d_cm.get<ConstraintTypePseudoBoolean>(constraint) << std::endl;
+				if (d_verbosity >= VERBOSITY_BASIC_INFO) {
+					cout << "Constraint not satisfied: ";
+					printConstraint<ConstraintTypePseudoBoolean>(d_cm.get<ConstraintTypePseudoBoolean>(constraint), cout, OutputFormatIlp);
+					cout << std::endl;
+				}
+			}
+			break;
 		default:
 			assert(false);
 		}
@@ -674,6 +880,40 @@ void Solver::printConstraintSMT(const std::vector<IntegerConstraintLiteral>& lit
     out << ")";
 }
 
+void Solver::getIntegerConstraint(ConstraintRef constraintRef, std::vector<IntegerConstraintLiteral>& literals, Integer& c) const {
+    literals.clear();
+    switch(ConstraintManager::getType(constraintRef)) {
+    case ConstraintTypeInteger: {
+        const IntegerConstraint& constraint = d_cm.get<ConstraintTypeInteger>(constraintRef);
+        for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+            literals.push_back(constraint.getLiteral(i));
+        }
+        c = constraint.getConstant();
+        break;
+    }
+    case ConstraintTypeInteger64: {
+        const Integer64Constraint& constraint = d_cm.get<ConstraintTypeInteger64>(constraintRef);
+        for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+            const Integer64ConstraintLiteral& literal = constraint.getLiteral(i);
+            literals.push_back(IntegerConstraintLiteral(literal.getCoefficient(), literal.getVariable()));
+        }
+        c = constraint.getConstant();
+        break;
+    }
+    case ConstraintTypePseudoBoolean: {
+        const PseudoBooleanConstraint& constraint = d_cm.get<ConstraintTypePseudoBoolean>(constraintRef);
+        for(unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+            const PseudoBooleanConstraintLiteral& literal = constraint.getLiteral(i);
+            literals.push_back(IntegerConstraintLiteral(literal.getCoefficient(), literal.getVariable()));
+        }
+        c = constraint.getConstant();
+        break;
+    }
+    default:
+        assert(false);
+    }
+}
+
 void Solver::addSlackVariableBound(Variable var) {
 
     assert(!d_state.hasLowerBound(var) || !d_state.hasUpperBound(var));
@@ -762,7 +1002,7 @@ void Solver::reduceConstraintDatabase() {
     d_solverStats.removedConstraints += (size - j);
     d_explanationConstraints.resize(j);
 
-    if (d_cm.getWasted() > 0.5*d_cm.getSize()) {
+    if (d_cm.getWasted() > 0.5*d_cm.getLearntSize()) {
     	collectGarbage();
     }
 }
@@ -802,9 +1042,25 @@ void Solver::removeConstraint(ConstraintRef constraintRef, ConstraintClass const
         break;
     case ConstraintTypeInteger:
         d_solverStats.integerConstraints --;
+        if (constraintClass == CONSTRAINT_CLASS_EXPLANATION) {
+            d_explanationIndex.erase(constraintRef);
+        }
     	d_propagators.removeConstraint<ConstraintTypeInteger>(constraintRef);
         d_cm.eraseConstraint<ConstraintTypeInteger>(constraintRef);
     	break;
+    case ConstraintTypeInteger64:
+        d_solverStats.integerConstraints --;
+        if (constraintClass == CONSTRAINT_CLASS_EXPLANATION) {
+            d_explanationIndex.erase(constraintRef);
+        }
+    	d_propagators.removeConstraint<ConstraintTypeInteger64>(constraintRef);
+        d_cm.eraseConstraint<ConstraintTypeInteger64>(constraintRef);
+    	break;
+    case ConstraintTypePseudoBoolean:
+        d_solverStats.pseudoBooleanConstraints --;
+    	d_propagators.removeConstraint<ConstraintTypePseudoBoolean>(constraintRef);
+        d_cm.eraseConstraint<ConstraintTypePseudoBoolean>(constraintRef);
+    	break;
     default:
     	assert(false);
     }
@@ -851,9 +1107,18 @@ void Solver::printProblemSmt(std::ostream& output, ConstraintRef implied) const
           case ConstraintTypeClause:
               printConstraint(d_cm.get<ConstraintTypeClause>(d_problemConstraints[i]), output, OutputFormatSmt);
               break;
+          case ConstraintTypeBinaryClause:
+              printConstraint(d_cm.getBinaryClause(d_problemConstraints[i]), output, OutputFormatSmt);
+              break;
           case ConstraintTypeInteger:
               printConstraint(d_cm.get<ConstraintTypeInteger>(d_problemConstraints[i]), output, OutputFormatSmt);
               break;
+          case ConstraintTypeInteger64:
+              printConstraint(d_cm.get<ConstraintTypeInteger64>(d_problemConstraints[i]), output, OutputFormatSmt);
+              break;
+          case ConstraintTypePseudoBoolean:
+              printConstraint(d_cm.get<ConstraintTypePseudoBoolean>(d_problemConstraints[i]), output, OutputFormatSmt);
+              break;
           default:
               assert(false);
       }
@@ -871,6 +1136,12 @@ void Solver::printProblemSmt(std::ostream& output, ConstraintRef implied) const
           case ConstraintTypeInteger:
               printConstraint(d_cm.get<ConstraintTypeInteger>(implied), output, OutputFormatSmt);
               break;
+          case ConstraintTypeInteger64:
+              printConstraint(d_cm.get<ConstraintTypeInteger64>(implied), output, OutputFormatSmt);
+              break;
+          case ConstraintTypePseudoBoolean:
+              printConstraint(d_cm.get<ConstraintTypePseudoBoolean>(implied), output, OutputFormatSmt);
+              break;
           default:
               assert(false);
       }
@@ -920,9 +1191,18 @@ void Solver::printProblemSmt2(std::ostream& output, ConstraintRef implied) const
           case ConstraintTypeClause:
               printConstraint(d_cm.get<ConstraintTypeClause>(d_problemConstraints[i]), output, OutputFormatSmt2);
               break;
+          case ConstraintTypeBinaryClause:
+              printConstraint(d_cm.getBinaryClause(d_problemConstraints[i]), output, OutputFormatSmt2);
+              break;
           case ConstraintTypeInteger:
               printConstraint(d_cm.get<ConstraintTypeInteger>(d_problemConstraints[i]), output, OutputFormatSmt2);
               break;
+          case ConstraintTypeInteger64:
+              printConstraint(d_cm.get<ConstraintTypeInteger64>(d_problemConstraints[i]), output, OutputFormatSmt2);
+              break;
+          case ConstraintTypePseudoBoolean:
+              printConstraint(d_cm.get<ConstraintTypePseudoBoolean>(d_problemConstraints[i]), output, OutputFormatSmt2);
+              break;
           default:
               assert(false);
           }
@@ -938,6 +1218,12 @@ void Solver::printProblemSmt2(std::ostream& output, ConstraintRef implied) const
           case ConstraintTypeInteger:
               printConstraint(d_cm.get<ConstraintTypeInteger>(implied), output, OutputFormatSmt2);
               break;
+          case ConstraintTypeInteger64:
+              printConstraint(d_cm.get<ConstraintTypeInteger64>(implied), output, OutputFormatSmt2);
+              break;
+          case ConstraintTypePseudoBoolean:
+              printConstraint(d_cm.get<ConstraintTypePseudoBoolean>(implied), output, OutputFormatSmt2);
+              break;
           default:
               assert(false);
       }
@@ -1002,25 +1288,27 @@ void Solver::printProblemMps(std::ostream& output, ConstraintRef implied) const
 
   // Define the rows
   for (unsigned i = 0; i < d_problemConstraints.size(); ++ i) {
-      const IntegerConstraint& constraint = d_cm.get<ConstraintTypeInteger>(d_problemConstraints[i]);
+      std::vector<IntegerConstraintLiteral> literals;
+      Integer constant;
+      getIntegerConstraint(d_problemConstraints[i], literals, constant);
 
-      int* indices = (int*)calloc(constraint.getSize(), sizeof(int));
-      double* elements = (double*)calloc(constraint.getSize(), sizeof(double));
+      int* indices = (int*)calloc(literals.size(), sizeof(int));
+      double* elements = (double*)calloc(literals.size(), sizeof(double));
 
-      for(unsigned lit = 0; lit < constraint.getSize(); ++ lit) {
-          const IntegerConstraintLiteral& literal = constraint.getLiteral(lit);
+      for(unsigned lit = 0; lit < literals.size(); ++ lit) {
+          const IntegerConstraintLiteral& literal = literals[lit];
           indices[lit] = literal.getVariable().getId();
           elements[lit] = NumberUtils<Integer>::toInt(literal.getCoefficient());
       }
 
       rowUb[i] = +inf;
-      rowLb[i] = NumberUtils<Integer>::toInt(constraint.getConstant());
+      rowLb[i] = NumberUtils<Integer>::toInt(constant);
 
       char row_name[100];
       sprintf(row_name, "ROW%d", i);
       ineq_names[i] = strdup(row_name);
 
-      matrix.appendRow(constraint.getSize(), indices, elements);
+      matrix.appendRow(literals.size(), indices, elements);
 
       free(indices);
       free(elements);
@@ -1083,9 +1371,11 @@ void Solver::printProblemOpb(std::ostream& output, ConstraintRef implied) const
 
   // Define the rows
   for (unsigned i = 0; i < d_problemConstraints.size(); ++ i) {
-      const IntegerConstraint& constraint = d_cm.get<ConstraintTypeInteger>(d_problemConstraints[i]);
-      for(unsigned lit = 0; lit < constraint.getSize(); ++ lit) {
-          const IntegerConstraintLiteral& literal = constraint.getLiteral(lit);
+      std::vector<IntegerConstraintLiteral> literals;
+      Integer constant;
+      getIntegerConstraint(d_problemConstraints[i], literals, constant);
+      for(unsigned lit = 0; lit < literals.size(); ++ lit) {
+          const IntegerConstraintLiteral& literal = literals[lit];
           const Integer& coefficient = literal.getCoefficient();
           unsigned variable = literal.getVariable().getId() + 1;
           if (coefficient > 0) {
@@ -1094,7 +1384,7 @@ void Solver::printProblemOpb(std::ostream& output, ConstraintRef implied) const
                   cout << coefficient << " x" << variable << " ";
           }
       }
-      cout << ">= " << constraint.getConstant() << " ;" << endl;
+      cout << ">= " << constant << " ;" << endl;
   }
 }
 
@@ -1121,6 +1411,9 @@ void Solver::printProblemCnf(std::ostream& output, ConstraintRef implied) const
            case ConstraintTypeClause:
                printConstraint(d_cm.get<ConstraintTypeClause>(d_problemConstraints[i]), output, OutputFormatCnf);
                break;
+           case ConstraintTypeBinaryClause:
+               printConstraint(d_cm.getBinaryClause(d_problemConstraints[i]), output, OutputFormatCnf);
+               break;
            default:
                assert(false);
        }
@@ -1161,30 +1454,32 @@ void Solver::printProblem(std::ostream& output, OutputFormat format, ConstraintR
 }
 
 void Solver::collectGarbage() {
-	std::map<ConstraintRef, ConstraintRef> reallocMap;
-
 	d_propagators.cleanAll();
 
+	// Problem constraints are never moved, only the learnt ones
 	d_cm.gcBegin();
-	d_cm.gcMove(d_problemConstraints, reallocMap);
-	d_cm.gcMove(d_explanationConstraints, reallocMap);
-	d_cm.gcMove(d_globalCutConstraints, reallocMap);
-	d_cm.gcEnd();
+	d_cm.gcMove(d_explanationConstraints);
+	d_cm.gcMove(d_globalCutConstraints);
 
-	d_state.gcUpdate(reallocMap);
-    d_propagators.gcUpdate(reallocMap);
+	// Follow the forwarding references, while the old copies are still there
+	d_state.gcUpdate(d_cm);
+    d_propagators.gcUpdate();
+    d_explanationIndex.gcUpdate();
 
     // Update the slack constraints
     if (d_slackVariable != VariableNull) {
     	for (unsigned i = 0, i_end = d_slackConstraintsLower.size(); i < i_end; ++ i) {
     		if (d_slackConstraintsLower[i] != ConstraintManager::NullConstraint) {
-    			d_slackConstraintsLower[i] = reallocMap[d_slackConstraintsLower[i]];
+    			d_slackConstraintsLower[i] = d_cm.gcRelocate(d_slackConstraintsLower[i]);
     		}
     		if (d_slackConstraintsUpper[i] != ConstraintManager::NullConstraint) {
-    			d_slackConstraintsUpper[i] = reallocMap[d_slackConstraintsUpper[i]];
+    			d_slackConstraintsUpper[i] = d_cm.gcRelocate(d_slackConstraintsUpper[i]);
     		}
     	}
     }
+
+    // Free the old learnt constraints
+    d_cm.gcEnd();
 }
 
 void Solver::bumpConstraint(ConstraintRef constraintRef) {
@@ -19,15 +19,21 @@
 
 #pragma once
 
+#include <deque>
+#include <queue>
 #include <vector>
 #include <sstream>
 
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
 #include "util/config.h"
 #include "solver/search_trail.h"
 #include "solver/variable_info.h"
 #include "solver/solver_state.h"
 #include "solver/solver_stats.h"
 #include "constraints/constraint_manager.h"
+#include "constraints/constraint_index.h"
 #include "propagators/watch_list_manager.h"
 
 #include "propagators/propagators.h"
@@ -36,6 +42,7 @@
 #include "heuristics/explanation_removal.h"
 
 #include "util/enums.h"
+#include "util/radix_heap.h"
 
 namespace cutsat {
 
@@ -73,33 +80,112 @@ inline std::ostream& operator << (std::ostream& out, const SolverStatus& status)
 
 class Solver {
 
+    /** The unit tests drive the conflict analysis directly */
+    friend struct SolverTestFixture;
+
 public:
 
-    struct constraint_coefficient_map {
-    	typedef std::map<Variable, Integer> coefficient_map;
-    	typedef coefficient_map::const_iterator const_iterator ;
-    	typedef coefficient_map::iterator iterator;
+    /**
+     * Coefficients of a constraint built during conflict analysis. The coefficients are kept densely in the order
+     * the variables were added, with an index from variable ids to positions for constant time lookup. The index is
+     * never cleared, a position is only valid if it points back to the variable, so clearing the map only costs the
+     * number of variables in it. Copies don't take the index, it is rebuilt on the first lookup.
+     */
+    class constraint_coefficient_map {
+
+    public:
+
+    	typedef std::pair<Variable, Integer> coefficient;
+    	typedef std::vector<coefficient> coefficient_vector;
+    	typedef coefficient_vector::const_iterator const_iterator;
+    	typedef coefficient_vector::iterator iterator;
 
     	ConstraintType constraintType;
-    	coefficient_map coefficients;
+    	coefficient_vector coefficients;
+
+    private:
+
+    	/** Positions of the variables in the coefficients, indexed by variable id */
+    	mutable std::vector<unsigned> d_positions;
+
+    	/** Whether the positions are up to date with the coefficients */
+    	mutable bool d_indexed;
+
+    	void setPosition(Variable var, unsigned position) const {
+    		unsigned id = var.getId();
+    		if (id >= d_positions.size()) {
+    			d_positions.resize(id + 1);
+    		}
+    		d_positions[id] = position;
+    	}
 
-    	Integer& operator [] (Variable var) { return coefficients[var]; }
+    	/** Returns the position of the variable in the coefficients, or the size if it's not there */
+    	unsigned getPosition(Variable var) const {
+    		if (!d_indexed) {
+    			for (unsigned i = 0; i < coefficients.size(); ++ i) {
+    				setPosition(coefficients[i].first, i);
+    			}
+    			d_indexed = true;
+    		}
+    		unsigned id = var.getId();
+    		if (id < d_positions.size()) {
+    			unsigned position = d_positions[id];
+    			if (position < coefficients.size() && coefficients[position].first == var) {
+    				return position;
+    			}
+    		}
+    		return coefficients.size();
+    	}
+
+    public:
+
+    	constraint_coefficient_map() : constraintType(ConstraintTypeLast), d_indexed(true) {}
+
+    	constraint_coefficient_map(const constraint_coefficient_map& other)
+    	: constraintType(other.constraintType), coefficients(other.coefficients), d_indexed(false) {}
+
+    	constraint_coefficient_map& operator = (const constraint_coefficient_map& other) {
+    		constraintType = other.constraintType;
+    		coefficients = other.coefficients;
+    		d_indexed = false;
+    		return *this;
+    	}
+
+    	Integer& operator [] (Variable var) {
+    		unsigned position = getPosition(var);
+    		if (position == coefficients.size()) {
+    			coefficients.push_back(coefficient(var, 0));
+    			setPosition(var, position);
+    		}
+    		return coefficients[position].second;
+    	}
 
     	void swap(constraint_coefficient_map& other) {
     		coefficients.swap(other.coefficients);
+    		d_positions.swap(other.d_positions);
+    		std::swap(d_indexed, other.d_indexed);
     		std::swap(constraintType, other.constraintType);
     	}
 
-    	constraint_coefficient_map() : constraintType(ConstraintTypeLast) {}
-
     	const_iterator begin() const { return coefficients.begin(); }
     	const_iterator end() const { return coefficients.end(); }
     	iterator begin() { return coefficients.begin(); }
     	iterator end() { return coefficients.end(); }
-    	const_iterator find(Variable var) const { return coefficients.find(var); }
-    	void erase(Variable var) { coefficients.erase(var); }
+    	const_iterator find(Variable var) const { return coefficients.begin() + getPosition(var); }
+
+    	/** Removes the variable by moving the last one in its place */
+    	void erase(Variable var) {
+    		unsigned position = getPosition(var);
+    		if (position < coefficients.size()) {
+    			if (position + 1 < coefficients.size()) {
+    				coefficients[position] = coefficients.back();
+    				setPosition(coefficients[position].first, position);
+    			}
+    			coefficients.pop_back();
+    		}
+    	}
 
-    	void clear() { coefficients.clear(); constraintType = ConstraintTypeLast; }
+    	void clear() { coefficients.clear(); d_indexed = true; constraintType = ConstraintTypeLast; }
     };
 
 private:
@@ -126,6 +212,9 @@ private:
     /** Constraints derived as global cuts */
     ConstraintDB d_globalCutConstraints;
 
+    /** Index of the integer explanation constraints, so that the same cut is not learned twice */
+    ConstraintIndex d_explanationIndex;
+
     /** How much to increase the variable score per bump */
     double d_constraintHeuristicIncrease;
     /** Decay factor for the variable scores */
@@ -137,9 +226,12 @@ private:
     std::map<Variable, Variable> d_variableToPositiveSlack;
     std::map<Variable, Variable> d_variableToNegativeSlack;
 
-    /** Index into the trail, to know what we've propagated so far */
+    /** Index into the trail, to know what we've propagated so far with the cheap propagators */
     unsigned d_propagationTrailIndex;
 
+    /** Index into the trail, to know what we've propagated so far with the expensive propagators */
+    unsigned d_expensivePropagationTrailIndex;
+
     /** Initial index when we started solving */
     int d_initialTrailIndex;
 
@@ -186,9 +278,25 @@ private:
      * that has not been traversed yet. The method returns whether a conflict has been
      * encountered during propagation. If a conflict has been encountered the constraints
      * responsible, and the variable in conflict are available in the solver state.
+     * The cheap propagators are run to fixpoint before each trail element is passed to
+     * the expensive ones.
      */
     void propagate();
 
+    /**
+     * Propagates the trail element with the given propagators.
+     */
+    void propagateEvent(const TrailElement& event, unsigned char propagators);
+
+    /**
+     * Restores the bounds undone by the last backtracks, in the order they were on the trail. While the bounds before
+     * a saved one hold again, its reason implies it again and it is enqueued directly, so it is re-derived without a
+     * search. The restored bounds are still dispatched to the propagators by the propagation loop, which keeps the
+     * watches consistent. A saved decision that is not made yet stops the restoring until it is, and once one got
+     * the other value, the Boolean reasons of the remaining ones are only repropagated on their own.
+     */
+    void restoreSavedTrail();
+
     /**
      * Backtrack to the given trail index.
      * @param backtrackIndex the index
@@ -218,6 +326,9 @@ private:
     /** Return the top variable in the constraint and the top trail index */
     void getTopTrailInfo(const constraint_coefficient_map& coefficients, Variable& topVariable, int& topTrailIndex);
 
+    /** The lower, upper and resolved coefficient maps of the conflict analysis, kept to reuse their index */
+    constraint_coefficient_map d_lowerBoundCoefficients, d_upperBoundCoefficients, d_resultCoefficients;
+
     /** Variables involved in the conflict */
     std::map<Variable, double> d_conflictVariables;
 
@@ -244,6 +355,13 @@ private:
     	bool operator == (const prop_variable_tag& other) const {
     		return type == other.type && variable == other.variable && lastModificationTime == other.lastModificationTime;
     	}
+    	friend size_t hash_value(const prop_variable_tag& tag) {
+    		size_t seed = 0;
+    		boost::hash_combine(seed, tag.variable.getId());
+    		boost::hash_combine(seed, tag.lastModificationTime);
+    		boost::hash_combine(seed, (int) tag.type);
+    		return seed;
+    	}
     };
 
     struct tight_cache_element {
@@ -251,7 +369,59 @@ private:
     	Integer constant;
     };
 
-    std::map<prop_variable_tag, tight_cache_element> d_tightConstraintCache;
+    typedef boost::unordered_map<prop_variable_tag, tight_cache_element, boost::hash<prop_variable_tag> > tight_cache;
+
+    /** Maximal number of tight constraints to keep in the cache, the oldest ones are evicted when full */
+    static const unsigned s_tightConstraintCacheLimit = 100000;
+
+    /** Tight constraints computed in conflict analysis, by the variable bound they explain */
+    tight_cache d_tightConstraintCache;
+
+    /** Keys of the cache with the latest trail index on top, to invalidate them on backtrack */
+    std::priority_queue<prop_variable_tag> d_tightConstraintCacheTrail;
+
+    /** Keys of the cache whose constraint is unit, these might still be asserted after a conflict */
+    std::vector<prop_variable_tag> d_tightConstraintCacheUnits;
+
+    /** A bound used in the derivation of a tight constraint, with its coefficient */
+    struct tight_term {
+    	prop_variable_tag tag;
+    	Integer coefficient;
+    	tight_term(const prop_variable_tag& tag, const Integer& coefficient)
+    	: tag(tag), coefficient(coefficient) {}
+    };
+
+    /**
+     * Positions of the terms of the current tight constraint derivation, indexed by the trail index of their bound.
+     * A position is only valid if the term there has the same tag. The nested derivations restore the positions
+     * they overwrite.
+     */
+    std::vector<unsigned> d_tightTermPositions;
+
+    /**
+     * The tight constraints of the eliminated bounds, one map per nesting level of the derivation, kept to reuse
+     * their index. A deque, since the deeper levels are added while the maps of the outer ones are in use.
+     */
+    std::deque<constraint_coefficient_map> d_tightCoefficients;
+
+    /** The nesting level of the current tight constraint derivation */
+    unsigned d_tightDerivationDepth;
+
+    /** Returns the coefficient of the bound in the derivation, adding it (and queueing it) if new */
+    Integer& getTightTerm(const prop_variable_tag& tag, std::vector<tight_term>& terms,
+    		std::vector<std::pair<unsigned, unsigned> >& overwrittenPositions, RadixHeap<unsigned>& queue);
+
+    /** Adds the tight constraint to the cache */
+    void cacheTightConstraint(const prop_variable_tag& tag, const constraint_coefficient_map& coefficients, const Integer& constant);
+
+    /** Removes the cached tight constraints computed above the given trail index */
+    void cancelTightConstraintCache(int trailIndex);
+
+    /**
+     * Evicts the tight constraints with the lowest trail index until the cache is half full. The unit ones are
+     * evicted last, since they are reasserted after conflicts.
+     */
+    void evictTightConstraintCache();
 
     ConstraintRef assertTightConstraint(const constraint_coefficient_map& coefficients, Integer& constant);
 
@@ -261,6 +431,65 @@ private:
      */
     void analyzeConflict();
 
+    /**
+     * Analyzes the current conflict as in CDCL if it only involves clauses, learning the first UIP clause. Returns
+     * false, without changing anything, if a reason that is not a clause is needed, in which case the general
+     * analysis should be used.
+     */
+    bool analyzeConflictClausal();
+
+    /** For each variable, the bound falsifying its literal (plus one) if seen in the clausal analysis, 0 otherwise */
+    std::vector<unsigned char> d_clausalSeen;
+
+    /** Variables seen in the clausal analysis */
+    std::vector<Variable> d_clausalSeenVariables;
+
+    /** The clause learned by the clausal analysis, the UIP literal first */
+    std::vector<ClauseConstraintLiteral> d_clausalLearnt;
+
+    /** Returns the reason of the current bound of the given type if it's a clause, or null otherwise */
+    ConstraintRef getClausalReason(Variable var, VariableModificationType type) const;
+
+    /** Returns the type of bound that makes the literal false */
+    static VariableModificationType getFalsifyingType(const ClauseConstraintLiteral& literal) {
+    	return literal.isNegated() ? MODIFICATION_LOWER_BOUND_REFINE : MODIFICATION_UPPER_BOUND_REFINE;
+    }
+
+    /** Returns the trail index of the bound that makes the literal false, or -1 if the literal is not false */
+    int getFalsifyingTrailIndex(const ClauseConstraintLiteral& literal) const;
+
+    /**
+     * Adds the literals of the clause, except the one of the skipped variable, to the clausal analysis. The literals
+     * at the conflict level are counted in pathCount, the ones below go into the learned clause. Returns false if a
+     * literal is not false.
+     */
+    template<typename Clause>
+    bool addClausalReason(const Clause& clause, Variable skip, unsigned conflictLevel, unsigned& pathCount);
+
+    /** Literals to check in the clause minimization */
+    std::vector<ClauseConstraintLiteral> d_minimizationStack;
+
+    /** A set of levels as a bit mask, used to quickly rule out literals in the clause minimization */
+    static unsigned getAbstractLevel(unsigned level) {
+    	return 1u << (level & 31);
+    }
+
+    /**
+     * Removes the false literals of the clause that are implied by the rest of the clause through clausal reasons.
+     * The first keep literals are not removed.
+     */
+    void minimizeClause(std::vector<ClauseConstraintLiteral>& literals, unsigned keep);
+
+    /** Returns true if the false literal is implied by the marked literals through clausal reasons */
+    bool isRedundant(const ClauseConstraintLiteral& literal, unsigned abstractLevels);
+
+    /**
+     * Marks the literals of the reason clause, except the skipped variable, and adds them to the minimization stack.
+     * Returns false if one of them can't be implied by the marked literals.
+     */
+    template<typename Clause>
+    bool addRedundantReason(const Clause& clause, Variable skip, unsigned abstractLevels);
+
     /**
      * Setup the coefficient map for the given variable at trail index, for the given modification type.
      * @param var
@@ -303,9 +532,14 @@ private:
     	d_state.printConstraint<type>(constraint, out, format);
     }
 
+    void printConstraint(const BinaryClause& constraint, std::ostream& out, OutputFormat format) const {
+    	d_state.printConstraint(constraint, out, format);
+    }
+
     ConstraintRef assertClauseConstraint(std::vector<ClauseConstraintLiteral>& literals, ConstraintClass constraintClass);
     ConstraintRef assertCardinalityConstraint(std::vector<CardinalityConstraintLiteral>& literals, unsigned& c, ConstraintClass constraintClass);
     ConstraintRef assertIntegerConstraint(std::vector<IntegerConstraintLiteral>& literals, Integer& c, ConstraintClass constraintClass);
+    ConstraintRef assertPseudoBooleanConstraint(std::vector<PseudoBooleanConstraintLiteral>& literals, Integer64& c, ConstraintClass constraintClass);
 
     void bumpConstraint(ConstraintRef constraintRef);
 
@@ -390,6 +624,17 @@ public:
     	return assertIntegerConstraint(literals, c, CONSTRAINT_CLASS_PROBLEM);
     }
 
+    /**
+     * Assert a new pseudo-Boolean constraint, i.e. a constraint of the form
+     * a_1 x_1 + a_2 x_2 + \cdots + a_n x_n \geq C, where the x_i are Boolean.
+     * @param literals the pseudo-Boolean literals (a_i x_i)
+     * @param C the right hand side
+     * @return the reference to the asserted constraint
+     */
+    ConstraintRef assertPseudoBooleanConstraint(std::vector<PseudoBooleanConstraintLiteral>& literals, Integer64& c) {
+    	return assertPseudoBooleanConstraint(literals, c, CONSTRAINT_CLASS_PROBLEM);
+    }
+
     inline bool hasUpperBound(Variable var) {
         return d_state.hasUpperBound(var);
     }
@@ -479,6 +724,11 @@ private:
      */
     void printConstraintSMT(const std::vector<IntegerConstraintLiteral>& literals, const Integer& c, std::ostream& out);
 
+    /**
+     * Get the literals and the constant of an integer constraint of either representation.
+     */
+    void getIntegerConstraint(ConstraintRef constraintRef, std::vector<IntegerConstraintLiteral>& literals, Integer& c) const;
+
     /** Whether to check the model */
     bool d_checkModel;
 
@@ -505,6 +755,9 @@ private:
 
     bool d_tryFourierMotzkin;
 
+    /** Backtrack only one level if conflict analysis would skip more levels than this (0 to always backjump) */
+    unsigned d_chronologicalBacktrackLevels;
+
     /** Check the model */
     void checkModel();
 
@@ -563,6 +816,13 @@ public:
         }
     }
 
+    void setChronologicalBacktrackLevels(unsigned levels) {
+        d_chronologicalBacktrackLevels = levels;
+        if (d_verbosity >= VERBOSITY_BASIC_INFO && levels > 0) {
+            std::cout << "Backtracking chronologically over jumps of more than " << levels << " levels." << std::endl;
+        }
+    }
+
     void setOutputCuts(bool flag) {
         d_outputCuts = flag;
     }
@@ -110,6 +110,8 @@ void SolverState::resize(size_t size) {
         d_variableInfo.resize(size);
         d_variableNames.resize(size);
         d_variablePhase.resize(size, true);
+        d_activityOccurrences.resize(2*size);
+        d_counterOccurrences.resize(2*size);
     }
 }
 
@@ -261,8 +263,108 @@ void SolverState::getLinearOrder(std::vector<Variable>& output) {
 	}
 }
 
-void SolverState::gcUpdate(const std::map<ConstraintRef, ConstraintRef>& reallocMap) {
+template<ConstraintType type>
+void SolverState::attachActivity(ConstraintRef constraintRef) {
+
+	TypedConstraint<type>& constraint = d_cm.get<type>(constraintRef);
+	const typename TypedConstraint<type>::literal_storage literals = constraint.getLiterals();
+	activity_data& activity = constraint.getAdditionalData();
+
+	activity = activity_data();
+	for (unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+		Variable var = literals.getVariable(i);
+		Integer coefficient = literals.getCoefficient(i);
+		if (coefficient > 0) {
+			if (hasUpperBound(var)) {
+				activity.maxActivity += coefficient * getUpperBound<TypeInteger>(var);
+			} else {
+				activity.unbounded ++;
+			}
+			getActivityOccurrences<MODIFICATION_UPPER_BOUND_REFINE>(var).push_back(activity_occurrence(constraintRef, coefficient));
+		} else {
+			if (hasLowerBound(var)) {
+				activity.maxActivity += coefficient * getLowerBound<TypeInteger>(var);
+			} else {
+				activity.unbounded ++;
+			}
+			getActivityOccurrences<MODIFICATION_LOWER_BOUND_REFINE>(var).push_back(activity_occurrence(constraintRef, coefficient));
+		}
+		Integer absCoefficient = NumberUtils<Integer>::abs(coefficient);
+		if (absCoefficient > activity.maxCoefficient) {
+			activity.maxCoefficient = absCoefficient;
+		}
+	}
+
+	CUTSAT_TRACE("solver::state") << constraint << ": " << activity << endl;
+}
+
+namespace cutsat {
+template void SolverState::attachActivity<ConstraintTypeInteger>(ConstraintRef constraintRef);
+template void SolverState::attachActivity<ConstraintTypeInteger64>(ConstraintRef constraintRef);
+}
+
+void SolverState::attachCounter(ConstraintRef constraintRef) {
+
+	CardinalityConstraint& constraint = d_cm.get<ConstraintTypeCardinality>(constraintRef);
+	counter_data& counter = constraint.getAdditionalData();
+
+	counter.counting = true;
+	counter.falseLiterals = 0;
+	for (unsigned i = 0, i_end = constraint.getSize(); i < i_end; ++ i) {
+		const CardinalityConstraintLiteral& literal = constraint.getLiteral(i);
+		Variable var = literal.getVariable();
+		if (literal.isNegated()) {
+			if (hasLowerBound(var) && isFalsifying<MODIFICATION_LOWER_BOUND_REFINE>(getLowerBound<TypeInteger>(var))) {
+				counter.falseLiterals ++;
+			}
+			getCounterOccurrences<MODIFICATION_LOWER_BOUND_REFINE>(var).push_back(constraintRef);
+		} else {
+			if (hasUpperBound(var) && isFalsifying<MODIFICATION_UPPER_BOUND_REFINE>(getUpperBound<TypeInteger>(var))) {
+				counter.falseLiterals ++;
+			}
+			getCounterOccurrences<MODIFICATION_UPPER_BOUND_REFINE>(var).push_back(constraintRef);
+		}
+	}
+
+	CUTSAT_TRACE("solver::state") << constraint << ": " << counter << endl;
+}
+
+void SolverState::gcUpdate(const ConstraintManager& cm) {
 	for (unsigned i = 0, i_end = d_variableInfo.size(); i < i_end; ++ i) {
-		d_variableInfo[i].gcUpdate(reallocMap);
+		d_variableInfo[i].gcUpdate(cm);
+	}
+	// Follow the reasons of the saved bounds, and drop them if one is gone
+	for (unsigned i = 0, i_end = d_savedTrail.size(); i < i_end; ++ i) {
+		ConstraintRef reason = d_savedTrail[i].reason;
+		if (reason != ConstraintManager::NullConstraint) {
+			if (!ConstraintManager::isBinaryClause(reason) && cm.get<ConstraintTypeClause>(reason).isDeleted()) {
+				d_savedTrail.clear();
+				break;
+			}
+			d_savedTrail[i].reason = cm.gcRelocate(reason);
+		}
+	}
+	// Drop the deleted constraints from the occurrences and relocate the rest
+	for (unsigned i = 0, i_end = d_activityOccurrences.size(); i < i_end; ++ i) {
+		std::vector<activity_occurrence>& occurrences = d_activityOccurrences[i];
+		unsigned j = 0;
+		for (unsigned k = 0, k_end = occurrences.size(); k < k_end; ++ k) {
+			ConstraintRef constraintRef = occurrences[k].constraint;
+			if (!cm.get<ConstraintTypeClause>(constraintRef).isDeleted()) {
+				occurrences[j] = occurrences[k];
+				occurrences[j++].constraint = cm.gcRelocate(constraintRef);
+			}
+		}
+		occurrences.resize(j, activity_occurrence(ConstraintManager::NullConstraint, 0));
+	}
+	for (unsigned i = 0, i_end = d_counterOccurrences.size(); i < i_end; ++ i) {
+		std::vector<ConstraintRef>& occurrences = d_counterOccurrences[i];
+		unsigned j = 0;
+		for (unsigned k = 0, k_end = occurrences.size(); k < k_end; ++ k) {
+			if (!cm.get<ConstraintTypeCardinality>(occurrences[k]).isDeleted()) {
+				occurrences[j++] = cm.gcRelocate(occurrences[k]);
+			}
+		}
+		occurrences.resize(j);
 	}
 }
@@ -137,6 +137,16 @@ public:
         inline void init() {}
     };
 
+    /** A bound undone by a backtrack, with the constraint that propagated it (null for decisions and unit bounds) */
+    struct saved_bound {
+    	Variable var;
+    	VariableModificationType type;
+    	Integer value;
+    	ConstraintRef reason;
+    	saved_bound(Variable var, VariableModificationType type, const Integer& value, ConstraintRef reason)
+    	: var(var), type(type), value(value), reason(reason) {}
+    };
+
 private:
 
     typedef __gnu_pbds::priority_queue<Variable, variable_compare_by_activity> dynamic_priority_queue;
@@ -182,6 +192,20 @@ private:
     /** Whether to use dynamic ordering */
     bool d_dynamicOrder;
 
+    /**
+     * The bounds undone by the last backtracks, the latest first, so that the earliest is at the back.
+     */
+    std::vector<saved_bound> d_savedTrail;
+
+    /** The size of the trail after the last backtrack, if nothing was added since the saved bounds can be extended */
+    unsigned d_savedTrailSize;
+
+    /**
+     * Saves the bound of the given type of the variable before it is popped by the backtrack visitor.
+     */
+    template<VariableModificationType type>
+    inline void saveBound(Variable var, ConstraintRef reason);
+
     /**
      * Resize the state so that it can accommodate the given number of variables.
      * @param size the size to ensure
@@ -200,6 +224,91 @@ private:
     std::vector< reassert_info<Integer> > d_integerReassertList;
     std::vector< reassert_info<Rational> > d_rationalReassertList;
 
+    /** An occurrence of a variable in an integer constraint, for keeping the activities up to date */
+    struct activity_occurrence {
+    	ConstraintRef constraint;
+    	Integer coefficient;
+    	activity_occurrence(ConstraintRef constraint, const Integer& coefficient)
+    	: constraint(constraint), coefficient(coefficient) {}
+    };
+
+    /** The occurrences of the variables in the integer constraints, at 2*id with negative and 2*id + 1 with positive coefficients */
+    std::vector< std::vector<activity_occurrence> > d_activityOccurrences;
+
+    /**
+     * Returns the occurrences whose activity depends on the bound of the given type, i.e. the negative ones for
+     * the lower bound and the positive ones for the upper bound.
+     */
+    template<VariableModificationType type>
+    std::vector<activity_occurrence>& getActivityOccurrences(Variable var) {
+    	return d_activityOccurrences[2*var.getId() + (type == MODIFICATION_UPPER_BOUND_REFINE ? 1 : 0)];
+    }
+
+    /**
+     * Adds the change to the activity of the constraint, with the change of the number of unbounded literals.
+     */
+    inline void changeActivity(ConstraintRef constraintRef, const Integer& change, int unboundedChange);
+
+    /**
+     * Updates the activities before the bound of the given type of the variable is set to the value.
+     */
+    template<VariableModificationType type>
+    inline void setActivityBound(Variable var, const Integer& value);
+
+    /**
+     * Rational variables don't appear in the integer constraints.
+     */
+    template<VariableModificationType type>
+    void setActivityBound(Variable var, const Rational& value) {}
+
+    /**
+     * Reverts the activities after the bound info of the given type of the variable is popped, and before
+     * the bound value is.
+     * @param init true if the variable has no bound of this type after the pop
+     */
+    template<VariableModificationType type>
+    inline void unsetActivityBound(Variable var, bool init);
+
+    /** The occurrences of the literals in the counting cardinality constraints, at 2*id the negated and at 2*id + 1 the positive ones */
+    std::vector< std::vector<ConstraintRef> > d_counterOccurrences;
+
+    /**
+     * Returns the counting constraints where the literal of the variable becomes false with the bound of the given
+     * type, i.e. the negated ones for the lower bound and the positive ones for the upper bound.
+     */
+    template<VariableModificationType type>
+    std::vector<ConstraintRef>& getCounterOccurrences(Variable var) {
+    	return d_counterOccurrences[2*var.getId() + (type == MODIFICATION_UPPER_BOUND_REFINE ? 1 : 0)];
+    }
+
+    /**
+     * Returns true if the bound of the given type makes the literals of the counting constraints false.
+     */
+    template<VariableModificationType type>
+    static bool isFalsifying(const Integer& bound) {
+    	return type == MODIFICATION_LOWER_BOUND_REFINE ? bound >= 1 : bound <= 0;
+    }
+
+    /**
+     * Counts the literals that become false before the bound of the given type of the variable is set to the value.
+     */
+    template<VariableModificationType type>
+    inline void setCounterBound(Variable var, const Integer& value);
+
+    /**
+     * Rational variables don't appear in the cardinality constraints.
+     */
+    template<VariableModificationType type>
+    void setCounterBound(Variable var, const Rational& value) {}
+
+    /**
+     * Reverts the counts after the bound info of the given type of the variable is popped, and before the bound
+     * value is.
+     * @param init true if the variable has no bound of this type after the pop
+     */
+    template<VariableModificationType type>
+    inline void unsetCounterBound(Variable var, bool init);
+
     template<VariableModificationType type>
     void addToUnitReassertList(Variable variable) {
     	switch (variable.getType()) {
@@ -233,7 +342,8 @@ public:
       d_variableCompare(d_variableHeuristic),
       d_variableQueueDynamic(d_variableCompare),
       d_backtrackVisitor(*this),
-      d_dynamicOrder(true)
+      d_dynamicOrder(true),
+      d_savedTrailSize(0)
       {}
 
     /**
@@ -522,8 +632,13 @@ public:
     }
 
     void cancelUntil(int index) {
+    	// Unless the trail is still as the last backtrack left it, the saved bounds are not the continuation
+    	if (getTrailSize() != d_savedTrailSize) {
+    		d_savedTrail.clear();
+    	}
     	d_backtrackVisitor.init();
         d_trail.cancelUntil(index, d_backtrackVisitor);
+        d_savedTrailSize = getTrailSize();
         if (d_inConflict) {
             if (!inQueue(d_conflictVariable)) {
               enqueueVariable(d_conflictVariable);
@@ -534,6 +649,34 @@ public:
 
     void reassertUnitBounds();
 
+    /**
+     * Returns true if some bounds undone by the last backtracks are saved.
+     */
+    bool hasSavedBounds() const {
+    	return !d_savedTrail.empty();
+    }
+
+    /**
+     * Returns the earliest of the saved bounds, i.e. the first one that was on the trail.
+     */
+    const saved_bound& getSavedBound() const {
+    	return d_savedTrail.back();
+    }
+
+    /**
+     * Removes the earliest of the saved bounds.
+     */
+    void popSavedBound() {
+    	d_savedTrail.pop_back();
+    }
+
+    /**
+     * Forgets all the saved bounds, e.g. on a restart.
+     */
+    void clearSavedTrail() {
+    	d_savedTrail.clear();
+    }
+
     /**
      * Get the last index at level 0.
      * @return
@@ -557,7 +700,22 @@ public:
     template <VariableModificationType eventType, VariableType variableType>
     void enqueueEvent(Variable var, typename VariableTraits<variableType>::value_type newValue, ConstraintRef reason);
 
-    void gcUpdate(const std::map<ConstraintRef, ConstraintRef>& reallocMap);
+    /**
+     * Computes the activity of the integer constraint with respect to the current bounds, and keeps it up to date
+     * from now on.
+     * @param constraintRef an integer constraint
+     */
+    template<ConstraintType type>
+    void attachActivity(ConstraintRef constraintRef);
+
+    /**
+     * Counts the false literals of the cardinality constraint with respect to the current bounds, and keeps the
+     * count up to date from now on.
+     * @param constraintRef a cardinality constraint
+     */
+    void attachCounter(ConstraintRef constraintRef);
+
+    void gcUpdate(const ConstraintManager& cm);
 
     std::string getVariableName(Variable var) const {
     	if (var == VariableNull) {
@@ -576,6 +734,10 @@ public:
     	constraint.print(out, *this, format);
     }
 
+    void printConstraint(const BinaryClause& constraint, std::ostream& out, OutputFormat format) const {
+    	constraint.print(out, *this, format);
+    }
+
 };
 
 template<>
@@ -605,6 +767,104 @@ inline unsigned SolverState::addBound<TypeRational>(const Rational& boundValue)
 template<VariableType type>
 inline unsigned addBound(typename VariableTraits<type>::value_type const& boundValue);
 
+inline void SolverState::changeActivity(ConstraintRef constraintRef, const Integer& change, int unboundedChange) {
+	switch (ConstraintManager::getType(constraintRef)) {
+	case ConstraintTypeInteger: {
+		activity_data& activity = d_cm.get<ConstraintTypeInteger>(constraintRef).getAdditionalData();
+		activity.maxActivity += change;
+		activity.unbounded += unboundedChange;
+		break;
+	}
+	case ConstraintTypeInteger64: {
+		activity_data& activity = d_cm.get<ConstraintTypeInteger64>(constraintRef).getAdditionalData();
+		activity.maxActivity += change;
+		activity.unbounded += unboundedChange;
+		break;
+	}
+	default:
+		assert(false);
+	}
+}
+
+template<VariableModificationType type>
+inline void SolverState::setActivityBound(Variable var, const Integer& value) {
+	std::vector<activity_occurrence>& occurrences = getActivityOccurrences<type>(var);
+	if (occurrences.empty()) return;
+	bool hasBound = type == MODIFICATION_LOWER_BOUND_REFINE ? hasLowerBound(var) : hasUpperBound(var);
+	if (hasBound) {
+		// The bound moves by the difference
+		Integer delta = value - (type == MODIFICATION_LOWER_BOUND_REFINE ? getLowerBound<TypeInteger>(var) : getUpperBound<TypeInteger>(var));
+		for (unsigned i = 0, i_end = occurrences.size(); i < i_end; ++ i) {
+			changeActivity(occurrences[i].constraint, occurrences[i].coefficient * delta, 0);
+		}
+	} else {
+		// The literal becomes bounded
+		for (unsigned i = 0, i_end = occurrences.size(); i < i_end; ++ i) {
+			changeActivity(occurrences[i].constraint, occurrences[i].coefficient * value, -1);
+		}
+	}
+}
+
+template<VariableModificationType type>
+inline void SolverState::unsetActivityBound(Variable var, bool init) {
+	std::vector<activity_occurrence>& occurrences = getActivityOccurrences<type>(var);
+	if (occurrences.empty()) return;
+	// The bound info is already popped, but the bound value is still the last one
+	const Integer& removed = d_boundsInteger.back();
+	if (init) {
+		// The literal becomes unbounded
+		for (unsigned i = 0, i_end = occurrences.size(); i < i_end; ++ i) {
+			changeActivity(occurrences[i].constraint, -(occurrences[i].coefficient * removed), 1);
+		}
+	} else {
+		// The bound moves back by the difference
+		Integer delta = (type == MODIFICATION_LOWER_BOUND_REFINE ? getLowerBound<TypeInteger>(var) : getUpperBound<TypeInteger>(var)) - removed;
+		for (unsigned i = 0, i_end = occurrences.size(); i < i_end; ++ i) {
+			changeActivity(occurrences[i].constraint, occurrences[i].coefficient * delta, 0);
+		}
+	}
+}
+
+template<VariableModificationType type>
+inline void SolverState::setCounterBound(Variable var, const Integer& value) {
+	std::vector<ConstraintRef>& occurrences = getCounterOccurrences<type>(var);
+	if (occurrences.empty() || !isFalsifying<type>(value)) return;
+	bool hasBound = type == MODIFICATION_LOWER_BOUND_REFINE ? hasLowerBound(var) : hasUpperBound(var);
+	if (hasBound && isFalsifying<type>(type == MODIFICATION_LOWER_BOUND_REFINE ? getLowerBound<TypeInteger>(var) : getUpperBound<TypeInteger>(var))) {
+		// Already false
+		return;
+	}
+	for (unsigned i = 0, i_end = occurrences.size(); i < i_end; ++ i) {
+		d_cm.get<ConstraintTypeCardinality>(occurrences[i]).getAdditionalData().falseLiterals ++;
+	}
+}
+
+template<VariableModificationType type>
+inline void SolverState::unsetCounterBound(Variable var, bool init) {
+	std::vector<ConstraintRef>& occurrences = getCounterOccurrences<type>(var);
+	if (occurrences.empty()) return;
+	// The bound info is already popped, but the bound value is still the last one
+	if (!isFalsifying<type>(d_boundsInteger.back())) return;
+	if (!init && isFalsifying<type>(type == MODIFICATION_LOWER_BOUND_REFINE ? getLowerBound<TypeInteger>(var) : getUpperBound<TypeInteger>(var))) {
+		// Still false
+		return;
+	}
+	for (unsigned i = 0, i_end = occurrences.size(); i < i_end; ++ i) {
+		d_cm.get<ConstraintTypeCardinality>(occurrences[i]).getAdditionalData().falseLiterals --;
+	}
+}
+
+template<VariableModificationType type>
+inline void SolverState::saveBound(Variable var, ConstraintRef reason) {
+	if (var.getType() != TypeInteger) {
+		// The bounds after this one might depend on it, so they can't be restored
+		d_savedTrail.clear();
+		return;
+	}
+	// The bound value is popped last
+	d_savedTrail.push_back(saved_bound(var, type, d_boundsInteger.back(), reason));
+}
+
 inline void SolverState::BacktrackVisitor::operator ()(const TrailElement& trailElement) {
 
     // Get the state of the variable
@@ -617,8 +877,10 @@ inline void SolverState::BacktrackVisitor::operator ()(const TrailElement& trail
       case MODIFICATION_LOWER_BOUND_REFINE: {
           // Remove the usage
           ConstraintRef reason = variableInfo.getLowerBoundConstraint();
+          // Keep the bound around to restore it later
+          d_state.saveBound<MODIFICATION_LOWER_BOUND_REFINE>(variable, reason);
           // Remove the user from the constraint
-          if (reason != ConstraintManager::NullConstraint) {
+          if (reason != ConstraintManager::NullConstraint && !ConstraintManager::isBinaryClause(reason)) {
             IntegerConstraint& constraint = d_state.d_cm.get<ConstraintTypeInteger>(reason);
             constraint.removeUser();
           }
@@ -651,12 +913,18 @@ inline void SolverState::BacktrackVisitor::operator ()(const TrailElement& trail
     	  }
     	  // Restore the old data
           variableInfo.popLowerBoundInfo();
+    	  if (variable.getType() == TypeInteger) {
+    		  d_state.unsetActivityBound<MODIFICATION_LOWER_BOUND_REFINE>(variable, trailElement.init);
+    		  d_state.unsetCounterBound<MODIFICATION_LOWER_BOUND_REFINE>(variable, trailElement.init);
+    	  }
           break;
       }
       case MODIFICATION_UPPER_BOUND_REFINE: {
           ConstraintRef reason = variableInfo.getUpperBoundConstraint();
+          // Keep the bound around to restore it later
+          d_state.saveBound<MODIFICATION_UPPER_BOUND_REFINE>(variable, reason);
     	  // Remove the user from the constraint
-          if (reason != ConstraintManager::NullConstraint) {
+          if (reason != ConstraintManager::NullConstraint && !ConstraintManager::isBinaryClause(reason)) {
             IntegerConstraint& constraint = d_state.d_cm.get<ConstraintTypeInteger>(reason);
             constraint.removeUser();
           }
@@ -689,6 +957,10 @@ inline void SolverState::BacktrackVisitor::operator ()(const TrailElement& trail
     	  }
           // Restore the old data
           variableInfo.popUpperBoundInfo();
+    	  if (variable.getType() == TypeInteger) {
+    		  d_state.unsetActivityBound<MODIFICATION_UPPER_BOUND_REFINE>(variable, trailElement.init);
+    		  d_state.unsetCounterBound<MODIFICATION_UPPER_BOUND_REFINE>(variable, trailElement.init);
+    	  }
           break;
       }
       default:
@@ -721,8 +993,8 @@ void SolverState::enqueueEvent(Variable var, typename VariableTraits<variableTyp
     // Index of the next trail element
 	unsigned trailIndex = getTrailSize();
 
-    if (reason != ConstraintManager::NullConstraint) {
-        // Add the user
+    if (reason != ConstraintManager::NullConstraint && !ConstraintManager::isBinaryClause(reason)) {
+        // Add the user (binary clauses are not in the memory, and never removed)
         IntegerConstraint& constraint = d_cm.get<ConstraintTypeInteger>(reason);
         constraint.addUser();
     }
@@ -734,7 +1006,9 @@ void SolverState::enqueueEvent(Variable var, typename VariableTraits<variableTyp
 		if (!variableInfo.hasLowerBound()) {
 			changeVariableHeuristicBound<MODIFICATION_LOWER_BOUND_REFINE, true>(var);
 		}
-        // Actually set the bound
+        // Update the activities and the counters, and actually set the bound
+        setActivityBound<MODIFICATION_LOWER_BOUND_REFINE>(var, newValue);
+        setCounterBound<MODIFICATION_LOWER_BOUND_REFINE>(var, newValue);
         setLowerBound<variableType>(var, newValue, reason, trailIndex);
         // Check for conflicts and assignment
         if (variableInfo.hasUpperBound()) {
@@ -757,7 +1031,9 @@ void SolverState::enqueueEvent(Variable var, typename VariableTraits<variableTyp
     	if (!variableInfo.hasUpperBound()) {
     		changeVariableHeuristicBound<MODIFICATION_UPPER_BOUND_REFINE, true>(var);
     	}
-    	// Actually set the bound
+    	// Update the activities and the counters, and actually set the bound
+    	setActivityBound<MODIFICATION_UPPER_BOUND_REFINE>(var, newValue);
+    	setCounterBound<MODIFICATION_UPPER_BOUND_REFINE>(var, newValue);
         setUpperBound<variableType>(var, newValue, reason, trailIndex);
         // Check for conflicts and assignment
         if (variableInfo.hasLowerBound()) {
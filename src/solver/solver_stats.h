@@ -43,16 +43,28 @@ struct SolverStats {
     unsigned globalCutConstraints;
     /** Number of removed constraints */
     unsigned removedConstraints;
+    /** Number of learned constraints that were already in the database */
+    unsigned duplicateConstraints;
     /** Number of created clause constraints */
     unsigned clauseConstraints;
     /** Number of created cardinality constraints */
     unsigned cardinalityConstraints;
     /** Number of created integer constraints */
     unsigned integerConstraints;
+    /** Number of created pseudo-Boolean constraints */
+    unsigned pseudoBooleanConstraints;
     /** Number of Fourier-Motzkin cuts */
     unsigned fourierMotzkinCuts;
     /** Number of dynamic cuts */
     unsigned dynamicCuts;
+    /** Number of conflicts analyzed with clauses only */
+    unsigned clausalConflicts;
+    /** Number of literals removed from learned clauses by minimization */
+    unsigned minimizedLiterals;
+    /** Number of bounds restored from the saved trail */
+    unsigned restoredBounds;
+    /** Number of chronological backtracks */
+    unsigned chronologicalBacktracks;
     /** Allocated constraint manager memory */
     unsigned constraintManagerCapacity;
     /** Size of the constraint manager memory */
@@ -72,11 +84,17 @@ struct SolverStats {
       explanationConstraints(0),
       globalCutConstraints(0),
       removedConstraints(0),
+      duplicateConstraints(0),
       clauseConstraints(0),
       cardinalityConstraints(0),
       integerConstraints(0),
+      pseudoBooleanConstraints(0),
       fourierMotzkinCuts(0),
       dynamicCuts(0),
+      clausalConflicts(0),
+      minimizedLiterals(0),
+      restoredBounds(0),
+      chronologicalBacktracks(0),
       constraintManagerCapacity(0),
       constraintManagerSize(0),
       constraintManagerWasted(0)
@@ -96,9 +114,15 @@ inline std::ostream& operator << (std::ostream& out, const SolverStats& stats) {
         << "Clause constraints      : " << stats.clauseConstraints << std::endl
         << "Cardinality constraints : " << stats.cardinalityConstraints << std::endl
         << "Integer constraints     : " << stats.integerConstraints << std::endl
+        << "PB constraints          : " << stats.pseudoBooleanConstraints << std::endl
         << "Removed constraints     : " << stats.removedConstraints << std::endl
+        << "Duplicate constraints   : " << stats.duplicateConstraints << std::endl
         << "Fourier-Motzkin cuts    : " << stats.fourierMotzkinCuts << std::endl
         << "Dynamic cuts            : " << stats.dynamicCuts << std::endl
+        << "Clausal conflicts       : " << stats.clausalConflicts << std::endl
+        << "Minimized literals      : " << stats.minimizedLiterals << std::endl
+        << "Restored bounds         : " << stats.restoredBounds << std::endl
+        << "Chronological backtracks: " << stats.chronologicalBacktracks << std::endl
         << "Allocated memory        : " << stats.constraintManagerCapacity << std::endl
         << "Used memory             : " << stats.constraintManagerSize << std::endl
         << "Wasted memory           : " << stats.constraintManagerWasted << std::endl
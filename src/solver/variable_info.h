@@ -289,32 +289,18 @@ public:
     	d_upperBoundInfo.pop_back();
     }
 
-    inline void gcUpdate(const std::map<ConstraintRef, ConstraintRef>& reallocMap) {
+    inline void gcUpdate(const ConstraintManager& cm) {
     	for(unsigned i = 0, i_end = d_lowerBoundInfo.size(); i < i_end; ++ i) {
     		ConstraintRef cRef = d_lowerBoundInfo[i].boundConstraint;
     		if (cRef != ConstraintManager::NullConstraint) {
-    			if (ConstraintManager::getFlag(cRef)) {
-    				assert(reallocMap.find(ConstraintManager::unsetFlag(cRef)) != reallocMap.end());
-    				cRef = ConstraintManager::setFlag(reallocMap.find(ConstraintManager::unsetFlag(cRef))->second);
-    			} else {
-    				assert(reallocMap.find(cRef) != reallocMap.end());
-    				cRef = reallocMap.find(cRef)->second;
-    			}
+    			d_lowerBoundInfo[i].boundConstraint = cm.gcRelocate(cRef);
     		}
-    		d_lowerBoundInfo[i].boundConstraint = cRef;
     	}
     	for(unsigned i = 0, i_end = d_upperBoundInfo.size(); i < i_end; ++ i) {
     		ConstraintRef cRef = d_upperBoundInfo[i].boundConstraint;
     		if (cRef != ConstraintManager::NullConstraint) {
-    			if (ConstraintManager::getFlag(cRef)) {
-    				assert(reallocMap.find(ConstraintManager::unsetFlag(cRef)) != reallocMap.end());
-    				cRef = ConstraintManager::setFlag(reallocMap.find(ConstraintManager::unsetFlag(cRef))->second);
-    			} else {
-    				assert(reallocMap.find(cRef) != reallocMap.end());
-    				cRef = reallocMap.find(cRef)->second;
-    			}
+    			d_upperBoundInfo[i].boundConstraint = cm.gcRelocate(cRef);
     		}
-    		d_upperBoundInfo[i].boundConstraint = cRef;
     	}
     }
 
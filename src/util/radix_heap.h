@@ -0,0 +1,113 @@
+/**
+ * Copyright 2010 Dejan Jovanovic.
+ *
+ * This file is part of cutsat.
+ *
+ * Cutsat is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cutsat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cutsat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cassert>
+
+namespace cutsat {
+
+/**
+ * Monotone priority queue of values with unsigned keys, largest key first. A pushed key can't be
+ * larger than the last popped one (or the initial top). The elements are kept in buckets by the
+ * highest bit where their key differs from the last popped key, so each element moves down at most
+ * once per bit and the buckets are plain vectors.
+ */
+template <typename Value>
+class RadixHeap {
+
+    typedef std::pair<unsigned, Value> element;
+
+    /** Number of buckets, one for the equal keys and one per bit */
+    static const unsigned s_bucketsCount = 33;
+
+    /** The buckets */
+    std::vector<element> d_buckets[s_bucketsCount];
+
+    /** The last popped key */
+    unsigned d_last;
+
+    /** Number of elements in the heap */
+    unsigned d_size;
+
+    static unsigned getBucket(unsigned key, unsigned last) {
+        unsigned diff = key ^ last;
+        return diff == 0 ? 0 : 32 - __builtin_clz(diff);
+    }
+
+    /** Make sure the elements with the largest key are in the first bucket */
+    void pull() {
+        if (!d_buckets[0].empty()) return;
+        unsigned i = 1;
+        while (d_buckets[i].empty()) { ++ i; }
+        std::vector<element>& bucket = d_buckets[i];
+        unsigned top = bucket[0].first;
+        for (unsigned j = 1; j < bucket.size(); ++ j) {
+            if (bucket[j].first > top) top = bucket[j].first;
+        }
+        d_last = top;
+        for (unsigned j = 0; j < bucket.size(); ++ j) {
+            d_buckets[getBucket(bucket[j].first, d_last)].push_back(bucket[j]);
+        }
+        bucket.clear();
+    }
+
+public:
+
+    RadixHeap(unsigned top)
+    : d_last(top), d_size(0) {}
+
+    bool empty() const {
+        return d_size == 0;
+    }
+
+    unsigned size() const {
+        return d_size;
+    }
+
+    void push(unsigned key, const Value& value) {
+        assert(key <= d_last);
+        d_buckets[getBucket(key, d_last)].push_back(element(key, value));
+        ++ d_size;
+    }
+
+    /** Returns the key of the top element */
+    unsigned topKey() {
+        assert(!empty());
+        pull();
+        return d_last;
+    }
+
+    /** Returns the value of the top element */
+    const Value& top() {
+        assert(!empty());
+        pull();
+        return d_buckets[0].back().second;
+    }
+
+    void pop() {
+        assert(!empty());
+        pull();
+        d_buckets[0].pop_back();
+        -- d_size;
+    }
+};
+
+}
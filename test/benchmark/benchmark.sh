@@ -0,0 +1,58 @@
+#!/bin/bash
+#
+# Builds cutsat with each of the number backends and times the regression
+# families (directories of test/regress/regression_tests.txt) with each build.
+#
+# Usage: benchmark.sh <source dir> <work dir> <backend>... [-- <cmake options>...]
+#
+
+SOURCE_DIR=$1
+WORK_DIR=$2
+shift 2
+
+BACKENDS=()
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    BACKENDS+=($1)
+    shift
+done
+[ "$1" == "--" ] && shift
+CMAKE_OPTIONS=("$@")
+
+TESTS=$SOURCE_DIR/test/regress/regression_tests.txt
+FAMILIES=`awk 'NF > 0 { print $1 }' $TESTS | xargs -n1 dirname | sort -u`
+
+# Build all the backends
+BUILT=()
+for BACKEND in ${BACKENDS[@]}; do
+    BUILD_DIR=$WORK_DIR/$BACKEND
+    mkdir -p $BUILD_DIR
+    echo "Building the $BACKEND backend in $BUILD_DIR"
+    if (cd $BUILD_DIR && cmake -DNUMBER_BACKEND=$BACKEND -DCMAKE_BUILD_TYPE=Release "${CMAKE_OPTIONS[@]}" $SOURCE_DIR > build.log 2>&1 && cmake --build . --target cutsat >> build.log 2>&1); then
+        BUILT+=($BACKEND)
+    else
+        echo "Could not build the $BACKEND backend, see $BUILD_DIR/build.log"
+    fi
+done
+
+# Time the families
+printf "%-40s" "family"
+for BACKEND in ${BUILT[@]}; do printf "%12s" $BACKEND; done
+echo
+for FAMILY in $FAMILIES; do
+    printf "%-40s" $FAMILY
+    for BACKEND in ${BUILT[@]}; do
+        CUTSAT=$WORK_DIR/$BACKEND/src/main/cutsat
+        FAILED=0
+        START=`date +%s%N`
+        while read FILE ARGS; do
+            [ "`dirname $FILE`" == "$FAMILY" ] || continue
+            $CUTSAT $SOURCE_DIR/$FILE $ARGS > /dev/null 2>&1 || FAILED=1
+        done < $TESTS
+        END=`date +%s%N`
+        # Time in seconds, marked with ! if any of the runs failed
+        TIME=`awk "BEGIN { printf \"%.3f\", ($END - $START) / 1000000000 }"`
+        [ $FAILED == 0 ] || TIME="!$TIME"
+        printf "%12s" $TIME
+    done
+    echo
+done
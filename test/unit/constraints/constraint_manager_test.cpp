@@ -1,6 +1,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include "constraints/constraint_manager.h"
+#include "constraints/constraint_index.h"
 
 using namespace cutsat;
 
@@ -30,4 +31,152 @@ BOOST_AUTO_TEST_CASE(Variables)
 	BOOST_CHECK(x_int != x_rational);
 }
 
+BOOST_AUTO_TEST_CASE(Segments)
+{
+	// Small segments, so that constraints span many of them
+	ConstraintManager d_cm(128);
+
+	std::vector<Variable> variables;
+	for (unsigned i = 0; i < 20; ++ i) {
+		variables.push_back(d_cm.newVariable(TypeInteger));
+	}
+
+	// Constraints of growing size, the last ones don't fit into a segment, every other one learnt
+	std::vector<ConstraintRef> constraints;
+	for (unsigned size = 2; size <= variables.size(); ++ size) {
+		std::vector<IntegerConstraintLiteral> literals;
+		for (unsigned i = 0; i < size; ++ i) {
+			literals.push_back(IntegerConstraintLiteral(i + 1, variables[i]));
+		}
+		constraints.push_back(d_cm.newConstraint<ConstraintTypeInteger>(literals, size, size % 2 == 0));
+	}
+	BOOST_CHECK(d_cm.getCapacity() > 128);
+	std::vector<ConstraintRef> oldConstraints = constraints;
+
+	// Collect, only the learnt ones move and the old copies forward to the new ones
+	d_cm.gcBegin();
+	d_cm.gcMove(constraints);
+	for (unsigned c = 0; c < constraints.size(); ++ c) {
+		BOOST_CHECK_EQUAL(constraints[c] != oldConstraints[c], d_cm.get<ConstraintTypeClause>(oldConstraints[c]).isLearnt());
+		BOOST_CHECK(d_cm.gcRelocate(oldConstraints[c]) == constraints[c]);
+		BOOST_CHECK(d_cm.gcRelocate(ConstraintManager::setFlag(oldConstraints[c])) == ConstraintManager::setFlag(constraints[c]));
+	}
+	d_cm.gcEnd();
+
+	// All must be intact
+	for (unsigned c = 0; c < constraints.size(); ++ c) {
+		const Integer64Constraint& constraint = d_cm.get<ConstraintTypeInteger64>(constraints[c]);
+		BOOST_CHECK_EQUAL(constraint.getSize(), c + 2);
+		BOOST_CHECK_EQUAL(constraint.getConstant(), c + 2);
+		BOOST_CHECK(!constraint.isMoved());
+		for (unsigned i = 0; i < constraint.getSize(); ++ i) {
+			BOOST_CHECK_EQUAL(constraint.getLiteral(i).getCoefficient(), i + 1);
+			BOOST_CHECK(constraint.getLiteral(i).getVariable() == variables[i]);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(BinaryClauses)
+{
+	ConstraintManager d_cm;
+
+	Variable x = d_cm.newVariable(TypeInteger);
+	Variable y = d_cm.newVariable(TypeInteger);
+
+	// Not in the memory, and the collection leaves them alone
+	ConstraintRef binary = d_cm.newBinaryClause(ClauseConstraintLiteral(x, false), ClauseConstraintLiteral(y, true));
+	BOOST_CHECK(ConstraintManager::isBinaryClause(binary));
+	BOOST_CHECK_EQUAL(d_cm.getSize(), 0u);
+	BOOST_CHECK(d_cm.gcRelocate(binary) == binary);
+	BOOST_CHECK(d_cm.gcRelocate(ConstraintManager::setFlag(binary)) == ConstraintManager::setFlag(binary));
+
+	const BinaryClause& clause = d_cm.getBinaryClause(binary);
+	BOOST_CHECK(clause.getLiteral(0).getVariable() == x);
+	BOOST_CHECK(clause.getLiteral(1).isNegated());
+	BOOST_CHECK_EQUAL(clause.getConstant(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(NativeIntegers)
+{
+	ConstraintManager d_cm;
+
+	Variable x = d_cm.newVariable(TypeInteger);
+	Variable y = d_cm.newVariable(TypeInteger);
+	Integer max = HybridInteger::maxSmall();
+	Integer min = HybridInteger::minSmall();
+
+	// Everything fits, the constraint is native with the same literals
+	std::vector<IntegerConstraintLiteral> literals;
+	literals.push_back(IntegerConstraintLiteral(max, x));
+	literals.push_back(IntegerConstraintLiteral(min, y));
+	ConstraintRef nativeRef = d_cm.newConstraint<ConstraintTypeInteger>(literals, max);
+	BOOST_CHECK(ConstraintManager::getType(nativeRef) == ConstraintTypeInteger64);
+	const Integer64Constraint& native = d_cm.get<ConstraintTypeInteger64>(nativeRef);
+	BOOST_CHECK_EQUAL(native.getSize(), 2u);
+	BOOST_CHECK(native.getLiteral(0).getVariable() == x);
+	BOOST_CHECK(native.getLiteral(0).getCoefficient() == max.getSmall());
+	BOOST_CHECK(native.getLiteral(1).getCoefficient() == min.getSmall());
+	BOOST_CHECK(native.getConstant() == max.getSmall());
+
+	// A coefficient that doesn't fit
+	literals[1] = IntegerConstraintLiteral(min - 1, y);
+	ConstraintRef bigCoefficientRef = d_cm.newConstraint<ConstraintTypeInteger>(literals, 0);
+	BOOST_CHECK(ConstraintManager::getType(bigCoefficientRef) == ConstraintTypeInteger);
+	BOOST_CHECK(d_cm.get<ConstraintTypeInteger>(bigCoefficientRef).getLiteral(1).getCoefficient() == min - 1);
+
+	// A constant that doesn't fit
+	literals[1] = IntegerConstraintLiteral(1, y);
+	ConstraintRef bigConstantRef = d_cm.newConstraint<ConstraintTypeInteger>(literals, max + 1);
+	BOOST_CHECK(ConstraintManager::getType(bigConstantRef) == ConstraintTypeInteger);
+	BOOST_CHECK(d_cm.get<ConstraintTypeInteger>(bigConstantRef).getConstant() == max + 1);
+}
+
+BOOST_AUTO_TEST_CASE(Index)
+{
+	ConstraintManager d_cm;
+	ConstraintIndex index(d_cm);
+
+	Variable x = d_cm.newVariable(TypeInteger);
+	Variable y = d_cm.newVariable(TypeInteger);
+
+	// A native one and a big one
+	std::vector<IntegerConstraintLiteral> small;
+	small.push_back(IntegerConstraintLiteral(2, x));
+	small.push_back(IntegerConstraintLiteral(-3, y));
+	std::vector<IntegerConstraintLiteral> big;
+	big.push_back(IntegerConstraintLiteral(HybridInteger::maxSmall() + 1, x));
+	big.push_back(IntegerConstraintLiteral(1, y));
+	ConstraintRef smallRef = d_cm.newConstraint<ConstraintTypeInteger>(small, 1, true);
+	ConstraintRef bigRef = d_cm.newConstraint<ConstraintTypeInteger>(big, 1, true);
+	BOOST_CHECK(ConstraintManager::getType(smallRef) == ConstraintTypeInteger64);
+	BOOST_CHECK(ConstraintManager::getType(bigRef) == ConstraintTypeInteger);
+	index.insert(smallRef);
+	index.insert(bigRef);
+
+	BOOST_CHECK(index.find(small, 1) == smallRef);
+	BOOST_CHECK(index.find(big, 1) == bigRef);
+	BOOST_CHECK(index.find(small, 2) == ConstraintManager::NullConstraint);
+	BOOST_CHECK_EQUAL(index.getDuplicates(), 2u);
+
+	// Follows the constraints when collected
+	std::vector<ConstraintRef> constraints;
+	constraints.push_back(smallRef);
+	constraints.push_back(bigRef);
+	d_cm.gcBegin();
+	d_cm.gcMove(constraints);
+	index.gcUpdate();
+	d_cm.gcEnd();
+	BOOST_CHECK(index.find(small, 1) == constraints[0]);
+	BOOST_CHECK(index.find(big, 1) == constraints[1]);
+
+	index.erase(constraints[0]);
+	BOOST_CHECK(index.find(small, 1) == ConstraintManager::NullConstraint);
+
+	// The propagators reorder the literals
+	d_cm.get<ConstraintTypeInteger>(constraints[1]).swapLiterals(0, 1);
+	BOOST_CHECK(index.find(big, 1) == constraints[1]);
+	index.erase(constraints[1]);
+	BOOST_CHECK(index.find(big, 1) == ConstraintManager::NullConstraint);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,40 @@
+#include <boost/test/unit_test.hpp>
+
+#include "constraints/number.h"
+#include <limits>
+
+using namespace cutsat;
+
+BOOST_AUTO_TEST_SUITE(NumberTest);
+
+BOOST_AUTO_TEST_CASE(HybridIntegers)
+{
+	Integer max = HybridInteger::maxSmall();
+	Integer min = HybridInteger::minSmall();
+	BOOST_CHECK(max.isSmall());
+	BOOST_CHECK(min.isSmall());
+
+	// Overflow promotes, coming back demotes
+	Integer big = max + 1;
+	BOOST_CHECK(!big.isSmall());
+	BOOST_CHECK(big > max);
+	BOOST_CHECK((big - 1).isSmall());
+	BOOST_CHECK(big - 1 == max);
+	BOOST_CHECK(!(-min).isSmall());
+	BOOST_CHECK(-min == big);
+	BOOST_CHECK(!(max * max).isSmall());
+	BOOST_CHECK(NumberUtils<Integer>::divideDown(max * max, max) == max);
+	BOOST_CHECK(Integer(std::numeric_limits<Integer64>::min()) < min);
+
+	// Rounding of the native division
+	BOOST_CHECK(NumberUtils<Integer>::divideDown(-7, 2) == -4);
+	BOOST_CHECK(NumberUtils<Integer>::divideUp(-7, 2) == -3);
+	BOOST_CHECK(NumberUtils<Integer>::divideDown(7, -2) == -4);
+	BOOST_CHECK(NumberUtils<Integer>::divideUp(7, 2) == 4);
+
+	BOOST_CHECK(NumberUtils<Integer>::gcd(-12, 18) == 6);
+	BOOST_CHECK(NumberUtils<Integer>::lcm(-4, 6) == 12);
+	BOOST_CHECK(NumberUtils<Integer>::lcm(max, max - 1) == max * (max - 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,219 @@
+#include <boost/test/unit_test.hpp>
+
+#include "propagators/propagators.h"
+#include <vector>
+
+using namespace std;
+using namespace cutsat;
+
+struct PseudoBooleanPropagatorTestFixture
+{
+
+	ConstraintManager d_cm;
+	SolverState d_solverState;
+	PropagatorCollection d_propagators;
+
+	/** Trail index of the next bound to propagate */
+	unsigned d_propagated;
+
+public:
+
+	PseudoBooleanPropagatorTestFixture()
+	: d_solverState(d_cm), d_propagators(d_cm, d_solverState), d_propagated(0) {
+    }
+
+    ~PseudoBooleanPropagatorTestFixture() {
+    }
+
+    /** Returns a new variable bounded to [0, 1] */
+    Variable newBoolean() {
+    	Variable var = d_cm.newVariable(TypeInteger);
+    	d_solverState.newVariable(var, "x");
+    	d_propagators.addVariable(var);
+    	d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(var, 0, ConstraintManager::NullConstraint);
+    	d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(var, 1, ConstraintManager::NullConstraint);
+    	d_propagated = d_solverState.getTrailSize();
+    	return var;
+    }
+
+    ConstraintRef attach(const vector<PseudoBooleanConstraintLiteral>& literals, Integer64 degree) {
+    	ConstraintRef constraintRef = d_cm.newConstraint<ConstraintTypePseudoBoolean>(literals, degree);
+    	d_propagators.attachConstraint<ConstraintTypePseudoBoolean>(constraintRef);
+    	return constraintRef;
+    }
+
+    void setFalse(Variable var) {
+    	d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(var, 0, ConstraintManager::NullConstraint);
+    }
+
+    /** Dispatches the new bounds on the trail to the propagators, as the solver does */
+    void propagate() {
+    	while (d_propagated < d_solverState.getTrailSize() && !d_solverState.inConflict()) {
+    		const TrailElement& event = d_solverState.getTrail()[d_propagated ++];
+    		if (event.modificationType == MODIFICATION_LOWER_BOUND_REFINE) {
+    			d_propagators.propagateEvent<MODIFICATION_LOWER_BOUND_REFINE>(event.var, PropagatorCollection::s_cheapPropagators);
+    		} else {
+    			d_propagators.propagateEvent<MODIFICATION_UPPER_BOUND_REFINE>(event.var, PropagatorCollection::s_cheapPropagators);
+    		}
+    	}
+    }
+
+    bool isTrue(Variable var) {
+    	return d_solverState.isAssigned(var) && d_solverState.getCurrentValue<TypeInteger>(var) == 1;
+    }
+
+    bool isFalse(Variable var) {
+    	return d_solverState.isAssigned(var) && d_solverState.getCurrentValue<TypeInteger>(var) == 0;
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(PseudoBooleanPropagatorTest, PseudoBooleanPropagatorTestFixture);
+
+BOOST_AUTO_TEST_CASE(preprocess)
+{
+	Variable x1 = newBoolean();
+	Variable x2 = newBoolean();
+	int zeroLevelIndex = d_solverState.getTrailSize() - 1;
+
+	// 3x1 + 2x2 >= c is consistent up to c = 5
+	vector<PseudoBooleanConstraintLiteral> literals;
+	literals.push_back(PseudoBooleanConstraintLiteral(3, x1));
+	literals.push_back(PseudoBooleanConstraintLiteral(2, x2));
+	Integer64 c = 5;
+	BOOST_CHECK(d_propagators.preprocess<ConstraintTypePseudoBoolean>(literals, c, zeroLevelIndex) == PREPROCESS_OK);
+	c = 6;
+	BOOST_CHECK(d_propagators.preprocess<ConstraintTypePseudoBoolean>(literals, c, zeroLevelIndex) == PREPROCESS_INCONSISTENT);
+
+	// -3x1 - 2x2 >= c is a tautology from c = -5 down
+	literals[0] = PseudoBooleanConstraintLiteral(-3, x1);
+	literals[1] = PseudoBooleanConstraintLiteral(-2, x2);
+	c = -4;
+	BOOST_CHECK(d_propagators.preprocess<ConstraintTypePseudoBoolean>(literals, c, zeroLevelIndex) == PREPROCESS_OK);
+	c = -5;
+	BOOST_CHECK(d_propagators.preprocess<ConstraintTypePseudoBoolean>(literals, c, zeroLevelIndex) == PREPROCESS_TAUTOLOGY);
+}
+
+BOOST_AUTO_TEST_CASE(propagateAboveSlack)
+{
+	vector<Variable> x;
+	vector<PseudoBooleanConstraintLiteral> literals;
+	for (unsigned i = 0; i < 4; ++ i) {
+		x.push_back(newBoolean());
+	}
+
+	// 5x0 + 4x1 + 3x2 + 2x3 >= 9, all literals are watched and nothing propagates
+	literals.push_back(PseudoBooleanConstraintLiteral(5, x[0]));
+	literals.push_back(PseudoBooleanConstraintLiteral(4, x[1]));
+	literals.push_back(PseudoBooleanConstraintLiteral(3, x[2]));
+	literals.push_back(PseudoBooleanConstraintLiteral(2, x[3]));
+	ConstraintRef constraintRef = attach(literals, 9);
+	unsigned trailSize = d_solverState.getTrailSize();
+	propagate();
+	BOOST_CHECK_EQUAL(d_solverState.getTrailSize(), trailSize);
+
+	// With x3 false the slack is 3, the weights above it propagate and the weight equal to it doesn't
+	setFalse(x[3]);
+	propagate();
+	BOOST_CHECK(!d_solverState.inConflict());
+	BOOST_CHECK(isTrue(x[0]));
+	BOOST_CHECK(isTrue(x[1]));
+	BOOST_CHECK(!d_solverState.isAssigned(x[2]));
+	BOOST_CHECK(d_solverState.getLowerBoundConstraint(x[0]) == constraintRef);
+	BOOST_CHECK(d_solverState.getLowerBoundConstraint(x[1]) == constraintRef);
+
+	// With x2 false too the slack is 0, which is still consistent
+	setFalse(x[2]);
+	propagate();
+	BOOST_CHECK(!d_solverState.inConflict());
+}
+
+BOOST_AUTO_TEST_CASE(zeroSlack)
+{
+	vector<Variable> x;
+	vector<PseudoBooleanConstraintLiteral> literals;
+	for (unsigned i = 0; i < 4; ++ i) {
+		x.push_back(newBoolean());
+	}
+	literals.push_back(PseudoBooleanConstraintLiteral(5, x[0]));
+	literals.push_back(PseudoBooleanConstraintLiteral(4, x[1]));
+	literals.push_back(PseudoBooleanConstraintLiteral(3, x[2]));
+	literals.push_back(PseudoBooleanConstraintLiteral(2, x[3]));
+	attach(literals, 9);
+
+	// x2 and x3 false at once leave exactly the degree, both others are implied
+	setFalse(x[2]);
+	setFalse(x[3]);
+	propagate();
+	BOOST_CHECK(!d_solverState.inConflict());
+	BOOST_CHECK(isTrue(x[0]));
+	BOOST_CHECK(isTrue(x[1]));
+}
+
+BOOST_AUTO_TEST_CASE(negativeSlack)
+{
+	vector<Variable> x;
+	vector<PseudoBooleanConstraintLiteral> literals;
+	for (unsigned i = 0; i < 4; ++ i) {
+		x.push_back(newBoolean());
+	}
+	literals.push_back(PseudoBooleanConstraintLiteral(5, x[0]));
+	literals.push_back(PseudoBooleanConstraintLiteral(4, x[1]));
+	literals.push_back(PseudoBooleanConstraintLiteral(3, x[2]));
+	literals.push_back(PseudoBooleanConstraintLiteral(2, x[3]));
+	ConstraintRef constraintRef = attach(literals, 9);
+
+	// x1 and x3 false at once leave one less than the degree
+	setFalse(x[1]);
+	setFalse(x[3]);
+	propagate();
+	BOOST_CHECK(d_solverState.inConflict());
+	Variable conflictVariable = d_solverState.getConflictVariable();
+	BOOST_CHECK(conflictVariable == x[0] || conflictVariable == x[2]);
+	BOOST_CHECK(d_solverState.getLowerBoundConstraint(conflictVariable) == constraintRef);
+}
+
+BOOST_AUTO_TEST_CASE(negatedLiterals)
+{
+	Variable x1 = newBoolean();
+	Variable x2 = newBoolean();
+	Variable x3 = newBoolean();
+
+	// -3x1 + 2x2 + 2x3 >= 1, i.e. 3(1 - x1) + 2x2 + 2x3 >= 4
+	vector<PseudoBooleanConstraintLiteral> literals;
+	literals.push_back(PseudoBooleanConstraintLiteral(-3, x1));
+	literals.push_back(PseudoBooleanConstraintLiteral(2, x2));
+	literals.push_back(PseudoBooleanConstraintLiteral(2, x3));
+	ConstraintRef constraintRef = attach(literals, 1);
+
+	// With x2 false the slack is 1, so x1 is false and x3 true
+	setFalse(x2);
+	propagate();
+	BOOST_CHECK(!d_solverState.inConflict());
+	BOOST_CHECK(isFalse(x1));
+	BOOST_CHECK(d_solverState.getUpperBoundConstraint(x1) == constraintRef);
+	BOOST_CHECK(isTrue(x3));
+}
+
+BOOST_AUTO_TEST_CASE(propagateOnAttach)
+{
+	Variable x1 = newBoolean();
+	Variable x2 = newBoolean();
+	Variable x3 = newBoolean();
+	Variable x4 = newBoolean();
+
+	// 3x1 + 3x2 + 1x3 + 1x4 >= 5 with x1 false leaves slack 0
+	setFalse(x1);
+	propagate();
+	vector<PseudoBooleanConstraintLiteral> literals;
+	literals.push_back(PseudoBooleanConstraintLiteral(3, x1));
+	literals.push_back(PseudoBooleanConstraintLiteral(3, x2));
+	literals.push_back(PseudoBooleanConstraintLiteral(1, x3));
+	literals.push_back(PseudoBooleanConstraintLiteral(1, x4));
+	attach(literals, 5);
+	BOOST_CHECK(!d_solverState.inConflict());
+	BOOST_CHECK(isTrue(x2));
+	BOOST_CHECK(isTrue(x3));
+	BOOST_CHECK(isTrue(x4));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -270,5 +270,91 @@ BOOST_AUTO_TEST_CASE(pushPopUpperMany)
 	}
 }
 
+BOOST_AUTO_TEST_CASE(cardinalityCounter)
+{
+	// Boolean variables
+	vector<Variable> x;
+	for (unsigned i = 0; i < 4; ++ i) {
+		x.push_back(d_cm.newVariable(TypeInteger));
+		d_solverState.newVariable(x[i], "x");
+		d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(x[i], 0, ConstraintManager::NullConstraint);
+		d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(x[i], 1, ConstraintManager::NullConstraint);
+	}
+
+	// x0 + x1 + x2 + !x3 >= 3, with x0 already false
+	d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(x[0], 0, ConstraintManager::NullConstraint);
+	vector<CardinalityConstraintLiteral> literals;
+	literals.push_back(CardinalityConstraintLiteral(x[0], false));
+	literals.push_back(CardinalityConstraintLiteral(x[1], false));
+	literals.push_back(CardinalityConstraintLiteral(x[2], false));
+	literals.push_back(CardinalityConstraintLiteral(x[3], true));
+	ConstraintRef constraintRef = d_cm.newConstraint<ConstraintTypeCardinality>(literals, 3);
+	d_solverState.attachCounter(constraintRef);
+	const counter_data& counter = d_cm.get<ConstraintTypeCardinality>(constraintRef).getAdditionalData();
+	BOOST_CHECK(counter.counting);
+	BOOST_CHECK_EQUAL(counter.falseLiterals, 1u);
+
+	// Making literals true or false again doesn't count
+	unsigned trailSize = d_solverState.getTrailSize();
+	d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(x[1], 1, ConstraintManager::NullConstraint);
+	BOOST_CHECK_EQUAL(counter.falseLiterals, 1u);
+	d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(x[3], 1, ConstraintManager::NullConstraint);
+	BOOST_CHECK_EQUAL(counter.falseLiterals, 2u);
+	d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(x[2], 0, ConstraintManager::NullConstraint);
+	BOOST_CHECK_EQUAL(counter.falseLiterals, 3u);
+
+	// Backtracking uncounts
+	d_solverState.cancelUntil(trailSize + 1);
+	BOOST_CHECK_EQUAL(counter.falseLiterals, 2u);
+	d_solverState.cancelUntil(trailSize - 1);
+	BOOST_CHECK_EQUAL(counter.falseLiterals, 1u);
+	d_solverState.cancelUntil(trailSize - 2);
+	BOOST_CHECK_EQUAL(counter.falseLiterals, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(savedTrail)
+{
+	// The variables
+	Variable x = d_cm.newVariable(TypeInteger);
+	Variable y = d_cm.newVariable(TypeInteger);
+	d_solverState.newVariable(x, "x");
+	d_solverState.newVariable(y, "y");
+
+	// The reason
+	vector<IntegerConstraintLiteral> literals;
+	literals.push_back(IntegerConstraintLiteral(1, x));
+	literals.push_back(IntegerConstraintLiteral(-1, y));
+	ConstraintRef c = d_cm.newConstraint(literals, 0);
+
+	// x >= 1, y <= 5, x >= 3 (c)
+	d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(x, 1, ConstraintManager::NullConstraint);
+	d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(y, 5, ConstraintManager::NullConstraint);
+	d_solverState.enqueueEvent<MODIFICATION_LOWER_BOUND_REFINE, TypeInteger>(x, 3, c);
+
+	// Backtracking twice saves the bounds, earliest first
+	d_solverState.cancelUntil(1);
+	d_solverState.cancelUntil(0);
+	BOOST_CHECK(d_solverState.hasSavedBounds());
+	BOOST_CHECK(d_solverState.getSavedBound().var == y);
+	BOOST_CHECK(d_solverState.getSavedBound().type == MODIFICATION_UPPER_BOUND_REFINE);
+	BOOST_CHECK(d_solverState.getSavedBound().value == 5);
+	BOOST_CHECK(d_solverState.getSavedBound().reason == ConstraintManager::NullConstraint);
+	d_solverState.popSavedBound();
+	BOOST_CHECK(d_solverState.getSavedBound().var == x);
+	BOOST_CHECK(d_solverState.getSavedBound().value == 3);
+	BOOST_CHECK(d_solverState.getSavedBound().reason == c);
+	d_solverState.popSavedBound();
+	BOOST_CHECK(!d_solverState.hasSavedBounds());
+
+	// Once the trail changed, the saved bounds start over
+	d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(y, 4, ConstraintManager::NullConstraint);
+	d_solverState.cancelUntil(0);
+	d_solverState.enqueueEvent<MODIFICATION_UPPER_BOUND_REFINE, TypeInteger>(y, 2, ConstraintManager::NullConstraint);
+	d_solverState.cancelUntil(0);
+	BOOST_CHECK(d_solverState.getSavedBound().value == 2);
+	d_solverState.popSavedBound();
+	BOOST_CHECK(!d_solverState.hasSavedBounds());
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
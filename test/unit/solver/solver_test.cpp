@@ -0,0 +1,379 @@
+#include <boost/test/unit_test.hpp>
+
+#include "solver/solver.h"
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+namespace cutsat {
+
+/** Befriended by the solver to get at the conflict analysis */
+struct SolverTestFixture
+{
+
+	ConstraintManager d_cm;
+	Solver d_solver;
+
+public:
+
+	SolverTestFixture()
+	: d_solver(d_cm) {
+    }
+
+    ~SolverTestFixture() {
+    }
+
+    Variable newInteger(const char* name) {
+    	return d_solver.newVariable(TypeInteger, name);
+    }
+
+    /** Returns a new variable bounded to [0, 1] */
+    Variable newBoolean(const char* name) {
+    	Variable var = newInteger(name);
+    	d_solver.setLowerBound<TypeInteger>(var, 0);
+    	d_solver.setUpperBound<TypeInteger>(var, 1);
+    	return var;
+    }
+
+    static ClauseConstraintLiteral pos(Variable var) {
+    	return ClauseConstraintLiteral(var, false);
+    }
+
+    static ClauseConstraintLiteral neg(Variable var) {
+    	return ClauseConstraintLiteral(var, true);
+    }
+
+    void addClause(ClauseConstraintLiteral l1, ClauseConstraintLiteral l2) {
+    	vector<ClauseConstraintLiteral> literals;
+    	literals.push_back(l1);
+    	literals.push_back(l2);
+    	d_solver.assertClauseConstraint(literals);
+    }
+
+    void addClause(ClauseConstraintLiteral l1, ClauseConstraintLiteral l2, ClauseConstraintLiteral l3) {
+    	vector<ClauseConstraintLiteral> literals;
+    	literals.push_back(l1);
+    	literals.push_back(l2);
+    	literals.push_back(l3);
+    	d_solver.assertClauseConstraint(literals);
+    }
+
+    /** Opens a new decision level with the given value of the Boolean variable, and propagates */
+    void decide(Variable var, bool value) {
+    	d_solver.d_state.setPhase(var, !value);
+    	d_solver.d_state.decideValue(var);
+    	d_solver.propagate();
+    }
+
+    bool inConflict() const {
+    	return d_solver.d_state.inConflict();
+    }
+
+    unsigned getDecisionLevel() const {
+    	return d_solver.d_state.getTrail().getDecisionLevel();
+    }
+
+    unsigned getTrailSize() const {
+    	return d_solver.d_state.getTrailSize();
+    }
+
+    bool isAssigned(Variable var) const {
+    	return d_solver.d_state.isAssigned(var);
+    }
+
+    bool isTrue(Variable var) const {
+    	return d_solver.d_state.isAssigned(var) && d_solver.d_state.getCurrentValue<TypeInteger>(var) == 1;
+    }
+
+    bool isFalse(Variable var) const {
+    	return d_solver.d_state.isAssigned(var) && d_solver.d_state.getCurrentValue<TypeInteger>(var) == 0;
+    }
+
+    /** Returns the level at which the Boolean variable got its value */
+    unsigned getLevel(Variable var) const {
+    	int trailIndex = isTrue(var) ? d_solver.d_state.getLowerBoundTrailIndex(var) : d_solver.d_state.getUpperBoundTrailIndex(var);
+    	return d_solver.d_state.getTrail().getLevelOfTrailIndex(trailIndex);
+    }
+
+    /** Returns true if the Boolean variable got its value from a clause */
+    bool hasClausalReason(Variable var) const {
+    	VariableModificationType type = isTrue(var) ? MODIFICATION_LOWER_BOUND_REFINE : MODIFICATION_UPPER_BOUND_REFINE;
+    	return d_solver.getClausalReason(var, type) != ConstraintManager::NullConstraint;
+    }
+
+    bool analyzeConflictClausal() {
+    	return d_solver.analyzeConflictClausal();
+    }
+
+    const vector<ClauseConstraintLiteral>& getLearnt() const {
+    	return d_solver.d_clausalLearnt;
+    }
+
+    bool isLearnt(ClauseConstraintLiteral literal) const {
+    	return std::find(getLearnt().begin(), getLearnt().end(), literal) != getLearnt().end();
+    }
+
+    void minimizeClause(vector<ClauseConstraintLiteral>& literals, unsigned keep) {
+    	d_solver.minimizeClause(literals, keep);
+    }
+
+    unsigned getTightCacheLimit() const {
+    	return Solver::s_tightConstraintCacheLimit;
+    }
+
+    unsigned getTightCacheSize() const {
+    	return d_solver.d_tightConstraintCache.size();
+    }
+
+    unsigned getTightCacheTrailSize() const {
+    	return d_solver.d_tightConstraintCacheTrail.size();
+    }
+
+    /** Caches the constraint sum vars >= 1 as the tight constraint of the lower bound of x at the trail index */
+    void cacheTight(Variable x, unsigned trailIndex, const vector<Variable>& vars) {
+    	Solver::constraint_coefficient_map coefficients;
+    	coefficients.constraintType = ConstraintTypeInteger;
+    	for (unsigned i = 0; i < vars.size(); ++ i) {
+    		coefficients[vars[i]] = 1;
+    	}
+    	d_solver.cacheTightConstraint(Solver::prop_variable_tag(x, trailIndex, MODIFICATION_LOWER_BOUND_REFINE), coefficients, 1);
+    }
+
+    bool isTightCached(Variable x, unsigned trailIndex) const {
+    	Solver::prop_variable_tag tag(x, trailIndex, MODIFICATION_LOWER_BOUND_REFINE);
+    	return d_solver.d_tightConstraintCache.find(tag) != d_solver.d_tightConstraintCache.end();
+    }
+
+    void cancelTightCache(int trailIndex) {
+    	d_solver.cancelTightConstraintCache(trailIndex);
+    }
+};
+
+} // End namespace cutsat
+
+using namespace cutsat;
+
+BOOST_FIXTURE_TEST_SUITE(SolverTest, SolverTestFixture);
+
+BOOST_AUTO_TEST_CASE(clausalFirstUip)
+{
+	Variable a = newBoolean("a");
+	Variable b = newBoolean("b");
+	Variable c = newBoolean("c");
+	Variable d = newBoolean("d");
+	Variable e = newBoolean("e");
+	Variable g = newBoolean("g");
+
+	// c implies d, which implies e and, with a, also g, but e and g clash
+	addClause(neg(c), pos(d));
+	addClause(neg(d), pos(e));
+	addClause(neg(a), neg(d), pos(g));
+	addClause(neg(e), neg(g));
+
+	decide(a, true);
+	decide(b, true);
+	decide(c, true);
+	BOOST_CHECK(inConflict());
+	BOOST_CHECK_EQUAL(getDecisionLevel(), 3u);
+
+	// The first UIP is d, not the decision c, and b is not involved
+	BOOST_REQUIRE(analyzeConflictClausal());
+	BOOST_CHECK_EQUAL(d_solver.getStatistics().clausalConflicts, 1u);
+	BOOST_CHECK_EQUAL(getLearnt().size(), 2u);
+	BOOST_CHECK(isLearnt(neg(d)));
+	BOOST_CHECK(isLearnt(neg(a)));
+
+	// Back at the level of a, where the learnt clause asserts ~d, which then gives ~c
+	BOOST_CHECK(!inConflict());
+	BOOST_CHECK_EQUAL(getDecisionLevel(), 1u);
+	BOOST_CHECK(isTrue(a));
+	BOOST_CHECK(!isAssigned(b));
+	BOOST_CHECK(isFalse(d));
+	BOOST_CHECK_EQUAL(getLevel(d), 1u);
+	BOOST_CHECK(hasClausalReason(d));
+	BOOST_CHECK(isFalse(c));
+	BOOST_CHECK_EQUAL(getLevel(c), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(clausalFallbackOnReason)
+{
+	Variable a = newBoolean("a");
+	Variable b = newBoolean("b");
+	Variable c = newBoolean("c");
+
+	// a + b + c >= 2, and not both b and c
+	vector<CardinalityConstraintLiteral> literals;
+	literals.push_back(CardinalityConstraintLiteral(a, false));
+	literals.push_back(CardinalityConstraintLiteral(b, false));
+	literals.push_back(CardinalityConstraintLiteral(c, false));
+	unsigned degree = 2;
+	d_solver.assertCardinalityConstraint(literals, degree);
+	addClause(neg(b), neg(c));
+
+	// With a false the cardinality constraint gives b and c
+	decide(a, false);
+	BOOST_CHECK(inConflict());
+	BOOST_CHECK(!hasClausalReason(b));
+	unsigned trailSize = getTrailSize();
+
+	// The bounds of b and c need the cardinality constraint, so nothing is learnt
+	BOOST_CHECK(!analyzeConflictClausal());
+	BOOST_CHECK(inConflict());
+	BOOST_CHECK_EQUAL(getTrailSize(), trailSize);
+	BOOST_CHECK_EQUAL(getDecisionLevel(), 1u);
+	BOOST_CHECK_EQUAL(d_solver.getStatistics().clausalConflicts, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(clausalFallbackOnConflict)
+{
+	Variable p = newBoolean("p");
+	Variable y = newBoolean("y");
+	Variable z = newBoolean("z");
+	Variable w = newBoolean("w");
+
+	// 2y + z + w >= 2, and p excludes y and z
+	vector<PseudoBooleanConstraintLiteral> literals;
+	literals.push_back(PseudoBooleanConstraintLiteral(2, y));
+	literals.push_back(PseudoBooleanConstraintLiteral(1, z));
+	literals.push_back(PseudoBooleanConstraintLiteral(1, w));
+	Integer64 degree = 2;
+	d_solver.assertPseudoBooleanConstraint(literals, degree);
+	addClause(neg(p), neg(y));
+	addClause(neg(p), neg(z));
+
+	// The clauses falsify y and z, which leaves the pseudo-Boolean constraint in conflict
+	decide(p, true);
+	BOOST_CHECK(inConflict());
+	unsigned trailSize = getTrailSize();
+
+	BOOST_CHECK(!analyzeConflictClausal());
+	BOOST_CHECK(inConflict());
+	BOOST_CHECK_EQUAL(getTrailSize(), trailSize);
+	BOOST_CHECK_EQUAL(d_solver.getStatistics().clausalConflicts, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(minimizeRedundantChain)
+{
+	Variable a = newBoolean("a");
+	Variable b = newBoolean("b");
+	Variable p = newBoolean("p");
+	Variable q = newBoolean("q");
+
+	// a implies p, which implies q
+	addClause(neg(a), pos(p));
+	addClause(neg(p), pos(q));
+
+	decide(a, true);
+	decide(b, true);
+	BOOST_CHECK(isTrue(q));
+
+	// ~q is implied by ~a through p, which is not in the clause
+	vector<ClauseConstraintLiteral> literals;
+	literals.push_back(neg(b));
+	literals.push_back(neg(q));
+	literals.push_back(neg(a));
+	minimizeClause(literals, 1);
+	BOOST_REQUIRE_EQUAL(literals.size(), 2u);
+	BOOST_CHECK(literals[0] == neg(b));
+	BOOST_CHECK(literals[1] == neg(a));
+	BOOST_CHECK_EQUAL(d_solver.getStatistics().minimizedLiterals, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(minimizeChainToDecision)
+{
+	Variable a = newBoolean("a");
+	Variable b = newBoolean("b");
+	Variable c = newBoolean("c");
+	Variable p = newBoolean("p");
+	Variable r = newBoolean("r");
+	Variable s = newBoolean("s");
+
+	// a implies p, c implies s, and together they imply r
+	addClause(neg(a), pos(p));
+	addClause(neg(c), pos(s));
+	addClause(neg(p), neg(s), pos(r));
+
+	decide(a, true);
+	decide(c, true);
+	decide(b, true);
+	BOOST_CHECK(isTrue(r));
+	BOOST_CHECK_EQUAL(getLevel(r), 2u);
+
+	// The reasons of r lead through s to the decision c, which is not in the clause, so ~r stays
+	vector<ClauseConstraintLiteral> literals;
+	literals.push_back(neg(b));
+	literals.push_back(neg(r));
+	literals.push_back(neg(a));
+	minimizeClause(literals, 1);
+	BOOST_REQUIRE_EQUAL(literals.size(), 3u);
+	BOOST_CHECK(literals[0] == neg(b));
+	BOOST_CHECK(literals[1] == neg(r));
+	BOOST_CHECK(literals[2] == neg(a));
+	BOOST_CHECK_EQUAL(d_solver.getStatistics().minimizedLiterals, 0u);
+
+	// With the decision in the clause ~r is implied again
+	literals.push_back(neg(c));
+	minimizeClause(literals, 1);
+	BOOST_REQUIRE_EQUAL(literals.size(), 3u);
+	BOOST_CHECK(literals[0] == neg(b));
+	BOOST_CHECK(literals[1] == neg(a));
+	BOOST_CHECK(literals[2] == neg(c));
+	BOOST_CHECK_EQUAL(d_solver.getStatistics().minimizedLiterals, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(tightCacheEvictsNonUnits)
+{
+	Variable x = newInteger("x");
+	Variable y = newInteger("y");
+	Variable z = newInteger("z");
+
+	vector<Variable> unit(1, x);
+	vector<Variable> nonUnit;
+	nonUnit.push_back(y);
+	nonUnit.push_back(z);
+
+	// The unit is the oldest entry
+	cacheTight(x, 0, unit);
+	unsigned limit = getTightCacheLimit();
+	for (unsigned i = 1; i < limit; ++ i) {
+		cacheTight(y, i, nonUnit);
+	}
+	BOOST_CHECK_EQUAL(getTightCacheSize(), limit);
+
+	// One more goes over the limit, the oldest non-units go
+	cacheTight(y, limit, nonUnit);
+	BOOST_CHECK_EQUAL(getTightCacheSize(), limit / 2 + 1);
+	BOOST_CHECK_EQUAL(getTightCacheTrailSize(), getTightCacheSize());
+	BOOST_CHECK(isTightCached(x, 0));
+	BOOST_CHECK(!isTightCached(y, 1));
+	BOOST_CHECK(!isTightCached(y, limit / 2));
+	BOOST_CHECK(isTightCached(y, limit / 2 + 1));
+	BOOST_CHECK(isTightCached(y, limit));
+
+	// The trail order is kept for the backtracking
+	cancelTightCache(limit - 10);
+	BOOST_CHECK_EQUAL(getTightCacheSize(), limit / 2 - 9);
+	BOOST_CHECK(isTightCached(y, limit - 10));
+	BOOST_CHECK(!isTightCached(y, limit - 9));
+	BOOST_CHECK(isTightCached(x, 0));
+}
+
+BOOST_AUTO_TEST_CASE(tightCacheEvictsUnits)
+{
+	Variable x = newInteger("x");
+	vector<Variable> unit(1, x);
+
+	// Only units, so the oldest of them go
+	unsigned limit = getTightCacheLimit();
+	for (unsigned i = 0; i <= limit; ++ i) {
+		cacheTight(x, i, unit);
+	}
+	BOOST_CHECK_EQUAL(getTightCacheSize(), limit / 2 + 1);
+	BOOST_CHECK_EQUAL(getTightCacheTrailSize(), getTightCacheSize());
+	BOOST_CHECK(!isTightCached(x, limit / 2 - 1));
+	BOOST_CHECK(isTightCached(x, limit / 2));
+	BOOST_CHECK(isTightCached(x, limit));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
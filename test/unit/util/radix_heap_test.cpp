@@ -0,0 +1,133 @@
+#include <boost/test/unit_test.hpp>
+
+#include "util/radix_heap.h"
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+using namespace cutsat;
+
+BOOST_AUTO_TEST_SUITE(RadixHeapTest);
+
+BOOST_AUTO_TEST_CASE(pushPop)
+{
+	RadixHeap<int> heap(100);
+	BOOST_CHECK(heap.empty());
+
+	unsigned keys[] = { 5, 80, 42, 100, 0, 63, 64, 1 };
+	for (unsigned i = 0; i < 8; ++ i) {
+		heap.push(keys[i], i);
+	}
+	BOOST_CHECK(heap.size() == 8);
+
+	// Largest key first, with the value pushed with it
+	unsigned sorted[] = { 100, 80, 64, 63, 42, 5, 1, 0 };
+	for (unsigned i = 0; i < 8; ++ i) {
+		BOOST_CHECK(heap.topKey() == sorted[i]);
+		BOOST_CHECK(keys[heap.top()] == sorted[i]);
+		heap.pop();
+		BOOST_CHECK(heap.size() == 7 - i);
+	}
+	BOOST_CHECK(heap.empty());
+}
+
+BOOST_AUTO_TEST_CASE(equalKeys)
+{
+	RadixHeap<int> heap(10);
+
+	heap.push(7, 0);
+	heap.push(3, 1);
+	heap.push(7, 2);
+	heap.push(10, 3);
+	heap.push(7, 4);
+	heap.push(3, 5);
+
+	BOOST_CHECK(heap.topKey() == 10);
+	BOOST_CHECK(heap.top() == 3);
+	heap.pop();
+
+	// The values with equal keys all come out, in any order
+	vector<int> values;
+	for (unsigned i = 0; i < 3; ++ i) {
+		BOOST_CHECK(heap.topKey() == 7);
+		values.push_back(heap.top());
+		heap.pop();
+	}
+	sort(values.begin(), values.end());
+	BOOST_CHECK(values[0] == 0 && values[1] == 2 && values[2] == 4);
+
+	// Equal to the last popped key is still allowed
+	heap.push(7, 6);
+	BOOST_CHECK(heap.topKey() == 7);
+	BOOST_CHECK(heap.top() == 6);
+	heap.pop();
+
+	values.clear();
+	for (unsigned i = 0; i < 2; ++ i) {
+		BOOST_CHECK(heap.topKey() == 3);
+		values.push_back(heap.top());
+		heap.pop();
+	}
+	sort(values.begin(), values.end());
+	BOOST_CHECK(values[0] == 1 && values[1] == 5);
+	BOOST_CHECK(heap.empty());
+}
+
+BOOST_AUTO_TEST_CASE(higherBucket)
+{
+	// The top is in the first bucket, the rest differ from it in the highest bits
+	RadixHeap<unsigned> heap(1024);
+	heap.push(1024, 1024);
+	heap.push(1000, 1000);
+	heap.push(513, 513);
+	heap.push(512, 512);
+	heap.push(3, 3);
+
+	BOOST_CHECK(heap.topKey() == 1024);
+	heap.pop();
+
+	// The next top has to be found in a higher bucket, the others are redistributed below it
+	BOOST_CHECK(heap.topKey() == 1000);
+	BOOST_CHECK(heap.top() == 1000);
+	heap.pop();
+
+	// Pushing below the new top after the redistribution
+	heap.push(999, 999);
+	heap.push(514, 514);
+	heap.push(0, 0);
+
+	unsigned sorted[] = { 999, 514, 513, 512, 3, 0 };
+	for (unsigned i = 0; i < 6; ++ i) {
+		BOOST_CHECK(heap.topKey() == sorted[i]);
+		BOOST_CHECK(heap.top() == sorted[i]);
+		heap.pop();
+	}
+	BOOST_CHECK(heap.empty());
+}
+
+BOOST_AUTO_TEST_CASE(monotone)
+{
+	// Interleaved pushes and pops against a sorted vector
+	unsigned top = 4000000000u;
+	RadixHeap<unsigned> heap(top);
+	vector<unsigned> expected;
+
+	unsigned random = 1;
+	for (unsigned i = 0; i < 2000; ++ i) {
+		random = random * 1103515245 + 12345;
+		if (random % 3 != 0 || expected.empty()) {
+			unsigned key = random % (top + 1);
+			heap.push(key, key);
+			expected.insert(lower_bound(expected.begin(), expected.end(), key), key);
+		} else {
+			BOOST_CHECK(heap.topKey() == expected.back());
+			BOOST_CHECK(heap.top() == expected.back());
+			top = expected.back();
+			expected.pop_back();
+			heap.pop();
+		}
+		BOOST_CHECK(heap.size() == expected.size());
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();